@@ -0,0 +1,139 @@
+///
+/// Domain block list benchmark
+///
+/// Compares the DomainBlockList (label trie with bloom filter), the trie alone
+/// and a QSet lookup of every parent domain of the host. The URL file contains
+/// one recorded request URL per line, block lists use the format of blockList files.
+/// Without block lists 50000 generated domains are used.
+///
+///  > BlockListBenchmark [iterations] [urls.txt] [blocklist.txt...]
+///
+
+#include <Util/DomainBlockList.hpp>
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QSet>
+#include <QElapsedTimer>
+
+#include <cstdio>
+#include <cstdlib>
+
+static const char *sampleUrls[] = {
+    "https://www.netflix.com/browse",
+    "https://assets.nflxext.com/en_us/ffe/player/html/cadmium-playercore-5.0008.544.011.js",
+    "https://occ-0-1723-92.1.nflxso.net/dnm/api/v6/E8vDc_W8CLv7-yMQu8KMEC7Rrr8/AAAABfBoxart.jpg",
+    "https://ipv4-c001-fra001-ix.1.oca.nflxvideo.net/range/0-65535?o=1&v=3&e=1565000000&t=abcdef",
+    "https://ichnaea.netflix.com/cl2",
+    "https://www.google-analytics.com/collect?v=1&t=pageview",
+    "https://tracker12345.metrics7.example/pixel.gif",
+    "https://cdn.tracker42.metrics3.example/beacon.js",
+};
+
+template<typename Lookup>
+static void run(const char *name, const Lookup &lookup, const QList<QUrl> &urls, int iterations)
+{
+    int blocked = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (auto n = 0; n < iterations; n++)
+        for (auto&& url : urls)
+            blocked += lookup(url.host());
+    const auto elapsed = timer.nsecsElapsed();
+
+    const double requests = double(iterations) * urls.size();
+    std::printf("%-20s %10.1f ns/request (%d blocked)\n", name, double(elapsed) / requests, blocked);
+}
+
+int main(int argc, char **argv)
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+    QList<QUrl> urls;
+    if (argc > 2)
+    {
+        QFile file(QString::fromLocal8Bit(argv[2]));
+        if (file.open(QFile::ReadOnly | QFile::Text))
+        {
+            while (!file.atEnd())
+            {
+                const auto line = QString::fromUtf8(file.readLine()).trimmed();
+                if (!line.isEmpty())
+                    urls.append(QUrl(line));
+            }
+        }
+    }
+    if (urls.isEmpty())
+        for (auto&& url : sampleUrls)
+            urls.append(QUrl(QString::fromLatin1(url)));
+
+    DomainBlockList blockList, trie;
+    QElapsedTimer timer;
+    timer.start();
+    for (auto i = 3; i < argc; i++)
+    {
+        blockList.addFile(QString::fromLocal8Bit(argv[i]));
+        trie.addFile(QString::fromLocal8Bit(argv[i]));
+    }
+    if (blockList.isEmpty())
+    {
+        blockList.add(QLatin1String("google-analytics.com"));
+        trie.add(QLatin1String("google-analytics.com"));
+        for (auto i = 0; i < 50000; i++)
+        {
+            const auto domain = QString("tracker%1.metrics%2.example").arg(i).arg(i % 10);
+            blockList.add(domain);
+            trie.add(domain);
+        }
+    }
+    blockList.compile();
+    std::printf("%d domain(s) compiled in %.1f ms, %d url(s), %d iterations\n",
+                blockList.count(), double(timer.nsecsElapsed()) / 1e6, urls.size(), iterations);
+
+    // the usual alternative, every parent domain of the host is looked up
+    QSet<QString> domains;
+    for (auto i = 3; i < argc; i++)
+    {
+        QFile file(QString::fromLocal8Bit(argv[i]));
+        if (file.open(QFile::ReadOnly | QFile::Text))
+        {
+            while (!file.atEnd())
+            {
+                // domain lists and hosts files only
+                const auto fields = QString::fromUtf8(file.readLine()).section('#', 0, 0).simplified().toLower().split(' ');
+                if (!fields.last().isEmpty())
+                    domains.insert(fields.last());
+            }
+        }
+    }
+    if (domains.isEmpty())
+    {
+        domains.insert(QLatin1String("google-analytics.com"));
+        for (auto i = 0; i < 50000; i++)
+            domains.insert(QString("tracker%1.metrics%2.example").arg(i).arg(i % 10));
+    }
+
+    run("trie + bloom filter", [&](const QString &host){
+        return blockList.contains(host);
+    }, urls, iterations);
+
+    run("trie", [&](const QString &host){
+        return trie.contains(host);
+    }, urls, iterations);
+
+    run("QSet (parents)", [&](const QString &host){
+        for (auto start = 0; start != -1; start = host.indexOf('.', start))
+        {
+            if (start != 0)
+                start++;
+            if (domains.contains(host.mid(start)))
+                return true;
+        }
+        return false;
+    }, urls, iterations);
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+///
+/// URL interceptor trace replay
+///
+/// Replays a request trace recorded with --record-trace= against the compiled
+/// rules of a provider file, the same steps as UrlRequestInterceptor::interceptRequest()
+/// (block list, rules and decision cache, header rules). The first pass starts with
+/// an empty decision cache, the following passes are warm. Runs headless and offline,
+/// the global block list of the configuration directory is used like in the app.
+///
+/// Every request is also matched without the decision cache on a separate rule set,
+/// the cold and the last warm pass must decide exactly the same for every request.
+/// Exits with 2 on the first differing decision, so rule engine changes can be gated on it.
+///
+///  > InterceptorReplay trace.bin file.p [iterations]
+///
+
+#include <Core/StreamingProviderParser.hpp>
+#include <Core/StreamingProviderStore.hpp>
+#include <Util/UrlInterceptorRules.hpp>
+#include <Util/RequestTrace.hpp>
+
+#include <QCoreApplication>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <cstdio>
+#include <cstdlib>
+
+struct Decisions
+{
+    quint64 passed = 0;
+    quint64 redirected = 0;
+    quint64 blocked = 0;
+    quint64 headers = 0;
+};
+
+// targets has one entry per request, empty for passed and blocked requests
+static void replay(const UrlInterceptorRules &rules, const QVector<RequestTrace::Request> &requests, Decisions *decisions, QVector<QUrl> *targets)
+{
+    for (auto i = 0; i < requests.size(); i++)
+    {
+        const auto &request = requests.at(i);
+        const auto host = request.url.host();
+        if (rules.blocks(host))
+        {
+            decisions->blocked++;
+            (*targets)[i] = QUrl();
+            continue;
+        }
+
+        const auto resourceType = UrlInterceptorLink::resourceTypeBit(request.resourceType);
+        QUrl target;
+        if (rules.covers(resourceType))
+            target = rules.decide(request.url, resourceType);
+
+        if (!target.isEmpty())
+        {
+            decisions->redirected++;
+        }
+        else
+        {
+            decisions->passed++;
+            if (rules.hasHttpHeaders())
+                decisions->headers += quint64(rules.httpHeaders(host).size());
+        }
+
+        (*targets)[i] = target;
+    }
+}
+
+// decisions of a rule set which never saw a request, without the decision cache
+static QVector<QUrl> reference(const UrlInterceptorRules &rules, const QVector<RequestTrace::Request> &requests)
+{
+    QVector<QUrl> targets(requests.size());
+    for (auto i = 0; i < requests.size(); i++)
+    {
+        const auto &request = requests.at(i);
+        if (rules.blocks(request.url.host()))
+            continue;
+
+        const auto resourceType = UrlInterceptorLink::resourceTypeBit(request.resourceType);
+        if (rules.covers(resourceType))
+            targets[i] = rules.resolve(request.url, resourceType);
+    }
+    return targets;
+}
+
+// index of the first request with a different target, -1 if all are the same
+static int compare(const QVector<QUrl> &expected, const QVector<QUrl> &targets, const QVector<RequestTrace::Request> &requests, const char *pass)
+{
+    for (auto i = 0; i < expected.size(); i++)
+    {
+        if (targets.at(i) != expected.at(i))
+        {
+            std::printf("Decision of the %s differs for request %d %s
+  expected: %s
+  decided:  %s
+",
+                        pass, i, qUtf8Printable(requests.at(i).url.toString()),
+                        qUtf8Printable(expected.at(i).toString()), qUtf8Printable(targets.at(i).toString()));
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void print(const char *name, qint64 elapsed, int passes, int requests)
+{
+    std::printf("%-12s %10.1f ns/request\n", name, double(elapsed) / (double(passes) * requests));
+}
+
+int main(int argc, char **argv)
+{
+    // same configuration directory as the app
+    QCoreApplication a(argc, argv);
+    a.setApplicationName(QLatin1String("LightweightQtDRMStreamViewer"));
+
+    if (argc < 3)
+    {
+        std::printf("Usage: %s trace.bin file.p [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    const int iterations = argc > 3 ? qMax(1, std::atoi(argv[3])) : 100;
+
+    QVector<RequestTrace::Request> requests;
+    if (!RequestTrace::load(QString::fromLocal8Bit(argv[1]), &requests) || requests.isEmpty())
+    {
+        std::printf("%s is not a valid request trace\n", argv[1]);
+        return 1;
+    }
+
+    Provider provider;
+    if (StreamingProviderParser::parseFile(QString::fromLocal8Bit(argv[2]), &provider) != StreamingProviderParser::SUCCESS)
+    {
+        std::printf("Unable to parse provider file %s\n", argv[2]);
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const UrlInterceptorRules rules(provider);
+    const auto compileTime = timer.nsecsElapsed();
+
+    std::printf("%d request(s), %d rule(s) compiled in %.1f ms, %d iterations\n",
+                requests.size(), rules.count(), double(compileTime) / 1e6, iterations);
+
+    const auto expected = reference(UrlInterceptorRules(provider), requests);
+    QVector<QUrl> targets(requests.size());
+
+    Decisions cold;
+    timer.restart();
+    replay(rules, requests, &cold, &targets);
+    print("cold cache", timer.nsecsElapsed(), 1, requests.size());
+
+    // cached decisions must not differ from matched ones
+    if (compare(expected, targets, requests, "cold pass") != -1)
+        return 2;
+
+    Decisions warm;
+    timer.restart();
+    for (auto n = 0; n < iterations; n++)
+        replay(rules, requests, &warm, &targets);
+    print("warm cache", timer.nsecsElapsed(), iterations, requests.size());
+
+    if (compare(expected, targets, requests, "last warm pass") != -1)
+        return 2;
+
+    std::printf("decisions    %llu passed, %llu redirected, %llu blocked, %llu headers set\n",
+                static_cast<unsigned long long>(cold.passed), static_cast<unsigned long long>(cold.redirected),
+                static_cast<unsigned long long>(cold.blocked), static_cast<unsigned long long>(cold.headers));
+
+    // hits of all passes
+    for (auto i = 0; i < rules.count(); i++)
+    {
+        const auto &link = rules.link(i);
+        std::printf("rule %3d %10llu hits  %s\n", i, static_cast<unsigned long long>(rules.hits(i)),
+                    qUtf8Printable(link.match.isValid() ? QString(link.match) : link.pattern.pattern()));
+    }
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+///
+/// Provider file tokenizer benchmark
+///
+/// Compares the former QString based line parsing (split + startsWith + mid().simplified())
+/// with the byte level ProviderFormat::Tokenizer. Reports heap allocations (malloc level, glibc only)
+/// and time per provider.
+///
+///  > ProviderParserBenchmark [iterations] [file.p...]
+///
+
+#include <Core/ProviderFormat.hpp>
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QRegExp>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static std::atomic<quint64> allocations{0};
+
+// Qt containers allocate with malloc() and realloc() directly (QArrayData, QListData),
+// operator new only covers a fraction. glibc only, the count is n/a elsewhere.
+#if defined(__GLIBC__)
+static const bool countingAllocations = true;
+
+extern "C" {
+
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+
+void *malloc(std::size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, std::size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+}
+#else
+static const bool countingAllocations = false;
+#endif
+
+static const char *sampleProvider =
+    "name:Netflix\n"
+    "icon:netflix.svgz\n"
+    "url:https://www.netflix.com\n"
+    "urlInterceptor:true\n"
+    "urlInterceptorPattern:(.*\\:\\/\\/assets\\.nflxext\\.com\\/.*\\/ffe\\/player\\/html\\/.*)|(.*\\:\\/\\/www\\.assets\\.nflxext\\.com\\/.*\\/ffe\\/player\\/html\\/.*)\n"
+    "urlInterceptorTarget:https://cdn.jsdelivr.net/gh/magiruuvelvet/netflix-1080p@master/cadmium-playercore-5.0008.544.011-1080p.js\n"
+    "\n"
+    "# comment\n"
+    "titlebar:true\n"
+    "titlebar-color:#060606\n"
+    "titlebar-text-color:#ffffff\n"
+    "titlebar-text:Netflix\n";
+
+// the former parsing approach, reduced to the string handling
+static int legacyParse(const QByteArray &bytes)
+{
+    static const char *keys[] = {
+        "name:", "icon:", "url:", "urlInterceptor:", "user-agent:", "titlebar:",
+        "titlebar-color:", "titlebar-text-color:", "titlebar-text:",
+        "urlInterceptorPattern:", "urlInterceptorTarget:", "script:", "httpAcceptLanguage:"
+    };
+
+    int values = 0;
+    const QString data = bytes;
+    const QStringList props = data.split(QRegExp("[\r\n]"), Qt::SkipEmptyParts);
+    for (auto&& i : props)
+    {
+        if (i.startsWith('#'))
+            continue;
+
+        for (auto&& key : keys)
+        {
+            if (i.startsWith(key, Qt::CaseInsensitive))
+            {
+                values += i.mid(int(std::strlen(key))).simplified().size() > 0;
+                break;
+            }
+        }
+    }
+    return values;
+}
+
+static int tokenizerParse(const QByteArray &bytes)
+{
+    int values = 0;
+    ProviderFormat::Tokenizer tokenizer(bytes);
+    ProviderFormat::Token token;
+    while (tokenizer.next(&token))
+    {
+        if (token.key != ProviderFormat::Key::Unknown)
+            values += token.value.toString().size() > 0;
+    }
+    return values;
+}
+
+static void run(const char *name, int (*parse)(const QByteArray&), const QList<QByteArray> &files, int iterations)
+{
+    int values = 0;
+    const quint64 allocationsBefore = allocations;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (auto n = 0; n < iterations; n++)
+        for (auto&& file : files)
+            values += parse(file);
+    const auto elapsed = timer.nsecsElapsed();
+
+    const double providers = double(iterations) * files.size();
+    if (countingAllocations)
+        std::printf("%-10s %10.1f allocations/provider %10.1f ns/provider (%d values)\n",
+                    name, double(allocations - allocationsBefore) / providers, double(elapsed) / providers, values);
+    else
+        std::printf("%-10s %10.1f ns/provider (%d values)\n",
+                    name, double(elapsed) / providers, values);
+}
+
+int main(int argc, char **argv)
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+    QList<QByteArray> files;
+    for (auto i = 2; i < argc; i++)
+    {
+        QFile file(QString::fromLocal8Bit(argv[i]));
+        if (file.open(QFile::ReadOnly))
+            files.append(file.readAll());
+    }
+    if (files.isEmpty())
+        files.append(QByteArray(sampleProvider));
+
+    std::printf("%d provider file(s), %d iterations\n", files.size(), iterations);
+    run("legacy", legacyParse, files, iterations);
+    run("tokenizer", tokenizerParse, files, iterations);
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+///
+/// URL interceptor matching benchmark
+///
+/// Compares the former loop over all patterns (QRegExp::exactMatch) with the
+/// translated QRegularExpression patterns and the UrlInterceptorMatcher (prefilter
+/// and combined expression) using QRegExp and QRegularExpression as engine,
+/// and the compiled rules with decision cache as used by UrlRequestInterceptor.
+/// Afterwards one rule per thumbnail variant is compared with a single rule
+/// using capture group references in the target.
+/// The URL file contains one recorded request URL per line.
+///
+///  > UrlInterceptorBenchmark [iterations] [urls.txt] [file.p...]
+///
+
+#include <Core/ProviderFormat.hpp>
+#include <Util/UrlInterceptorMatcher.hpp>
+#include <Util/RegExpCompat.hpp>
+#include <Util/UrlInterceptorRules.hpp>
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QRegExp>
+#include <QRegularExpression>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <cstdio>
+#include <cstdlib>
+
+static const char *sampleProvider =
+    "urlInterceptorPattern:(.*\\:\\/\\/assets\\.nflxext\\.com\\/.*\\/ffe\\/player\\/html\\/.*)|(.*\\:\\/\\/www\\.assets\\.nflxext\\.com\\/.*\\/ffe\\/player\\/html\\/.*)\n"
+    "urlInterceptorTarget:https://cdn.jsdelivr.net/gh/magiruuvelvet/netflix-1080p@master/cadmium-playercore-5.0008.544.011-1080p.js\n";
+
+static const char *sampleUrls[] = {
+    "https://www.netflix.com/browse",
+    "https://assets.nflxext.com/en_us/ffe/player/html/cadmium-playercore-5.0008.544.011.js",
+    "https://assets.nflxext.com/ffe/siteui/common/icons/nficon2016.ico",
+    "https://occ-0-1723-92.1.nflxso.net/dnm/api/v6/E8vDc_W8CLv7-yMQu8KMEC7Rrr8/AAAABfBoxart.jpg",
+    "https://ipv4-c001-fra001-ix.1.oca.nflxvideo.net/range/0-65535?o=1&v=3&e=1565000000&t=abcdef",
+    "https://ipv4-c001-fra001-ix.1.oca.nflxvideo.net/range/65536-131071?o=1&v=3&e=1565000000&t=abcdef",
+    "https://ichnaea.netflix.com/cl2",
+    "https://www.netflix.com/api/shakti/v1/pathEvaluator?withSize=true&materialize=true",
+};
+
+static QList<UrlInterceptorLink> readLinks(const QByteArray &bytes)
+{
+    QList<UrlInterceptorLink> links;
+
+    ProviderFormat::Tokenizer tokenizer(bytes);
+    ProviderFormat::Token token;
+    while (tokenizer.next(&token))
+    {
+        if (token.key == ProviderFormat::Key::UrlInterceptorPattern)
+            links.append(UrlInterceptorLink{QRegExp(token.value.toString()), QUrl()});
+        else if (token.key == ProviderFormat::Key::UrlInterceptorMatch)
+            links.append(UrlInterceptorLink{QRegExp(), QUrl(), UrlMatch::parse(token.value.toString())});
+        else if (token.key == ProviderFormat::Key::UrlInterceptorTarget && !links.isEmpty())
+            links.last().target = QUrl(token.value.toString());
+    }
+
+    return links;
+}
+
+template<typename Match>
+static void run(const char *name, const Match &match, const QList<QUrl> &urls, int iterations)
+{
+    int matches = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (auto n = 0; n < iterations; n++)
+        for (auto&& url : urls)
+            matches += match(url) != -1;
+    const auto elapsed = timer.nsecsElapsed();
+
+    const double requests = double(iterations) * urls.size();
+    std::printf("%-20s %10.1f ns/request (%d matches)\n", name, double(elapsed) / requests, matches);
+}
+
+// rule count: one rule per thumbnail variant vs. one rule with capture group references
+// returns false if the targets differ
+static bool runSubstitution(int iterations)
+{
+    static const int sizes[] = {320, 480, 640, 1280};
+    static const int ids = 64;
+
+    QList<UrlInterceptorLink> variants;
+    for (auto&& size : sizes)
+        for (auto id = 0; id < ids; id++)
+            variants.append(UrlInterceptorLink{
+                QRegExp(QString(".*://img\\.example\\.com/thumb/w%1/%2\\.jpg(\\?.*)?").arg(size).arg(id)),
+                QUrl(QString("https://img.example.com/thumb/w160/%1.jpg").arg(id))});
+
+    const QList<UrlInterceptorLink> substitution{UrlInterceptorLink{
+        QRegExp(".*://img\\.example\\.com/thumb/w\\d+/(\\d+)\\.jpg(\\?.*)?"),
+        QUrl("https://img.example.com/thumb/w160/\\1.jpg")}};
+
+    // more distinct urls than the decision cache holds, every request is matched
+    QList<QUrl> urls;
+    for (auto i = 0; i < 2048; i++)
+        urls.append(QUrl(QString("https://img.example.com/thumb/w%1/%2.jpg?v=%3").arg(sizes[(i / ids) % 4]).arg(i % ids).arg(i)));
+
+    std::printf("\nthumbnail rewrite, %d url(s), %d iterations\n", urls.size(), iterations);
+
+    const UrlInterceptorRules variantRules(variants);
+    run(qUtf8Printable(QString("%1 variant rules").arg(variants.size())), [&](const QUrl &url){
+        return variantRules.decide(url, UrlInterceptorLink::AllResourceTypes).isEmpty() ? -1 : 0;
+    }, urls, iterations);
+
+    const UrlInterceptorRules substitutionRules(substitution);
+    run("1 rule with \\1", [&](const QUrl &url){
+        return substitutionRules.decide(url, UrlInterceptorLink::AllResourceTypes).isEmpty() ? -1 : 0;
+    }, urls, iterations);
+
+    // both have to produce the same targets
+    for (auto&& url : urls)
+    {
+        if (variantRules.decide(url, UrlInterceptorLink::AllResourceTypes) != substitutionRules.decide(url, UrlInterceptorLink::AllResourceTypes))
+        {
+            std::printf("Target mismatch for %s\n", qUtf8Printable(url.toString()));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+    QList<QUrl> urls;
+    if (argc > 2)
+    {
+        QFile file(QString::fromLocal8Bit(argv[2]));
+        if (file.open(QFile::ReadOnly | QFile::Text))
+        {
+            while (!file.atEnd())
+            {
+                const auto line = QString::fromUtf8(file.readLine()).trimmed();
+                if (!line.isEmpty())
+                    urls.append(QUrl(line));
+            }
+        }
+    }
+    if (urls.isEmpty())
+        for (auto&& url : sampleUrls)
+            urls.append(QUrl(QString::fromLatin1(url)));
+
+    QList<UrlInterceptorLink> links;
+    for (auto i = 3; i < argc; i++)
+    {
+        QFile file(QString::fromLocal8Bit(argv[i]));
+        if (file.open(QFile::ReadOnly))
+            links.append(readLinks(file.readAll()));
+    }
+    if (links.isEmpty())
+        links = readLinks(QByteArray(sampleProvider));
+
+    std::printf("%d rule(s), %d url(s), %d iterations\n", links.size(), urls.size(), iterations);
+
+    // former interceptRequest(), serializes the url for every rule
+    run("loop (QRegExp)", [&](const QUrl &url){
+        for (auto i = 0; i < links.size(); i++)
+            if (links.at(i).pattern.exactMatch(url.toString()))
+                return i;
+        return -1;
+    }, urls, iterations);
+
+    QVector<QRegularExpression> expressions;
+    for (auto&& link : links)
+    {
+        QRegularExpression expression;
+        if (RegExpCompat::exactMatch(link.pattern, &expression))
+            expressions.append(expression);
+        else
+            std::printf("Pattern %s can't be translated, skipped.\n", qUtf8Printable(link.pattern.pattern()));
+    }
+    run("loop (PCRE2 JIT)", [&](const QUrl &url){
+        const auto str = url.toString();
+        for (auto i = 0; i < expressions.size(); i++)
+            if (expressions.at(i).match(str).hasMatch())
+                return i;
+        return -1;
+    }, urls, iterations);
+
+    const UrlInterceptorMatcher legacy(links, UrlInterceptorMatcher::LegacyRegExp);
+    run("matcher (QRegExp)", [&](const QUrl &url){
+        return legacy.match(url);
+    }, urls, iterations);
+
+    const UrlInterceptorMatcher matcher(links, UrlInterceptorMatcher::RegularExpression);
+    run("matcher (PCRE2 JIT)", [&](const QUrl &url){
+        return matcher.match(url);
+    }, urls, iterations);
+
+    const UrlInterceptorRules rules(links);
+    run("rules (cached)", [&](const QUrl &url){
+        return rules.decide(url, UrlInterceptorLink::AllResourceTypes).isEmpty() ? -1 : 0;
+    }, urls, iterations);
+
+    if (!runSubstitution(qMax(1, iterations / 100)))
+        return 2;
+
+    return 0;
+}
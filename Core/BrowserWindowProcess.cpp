@@ -2,9 +2,13 @@
 
 #include <QApplication>
 #include <QMutexLocker>
+#include <QDataStream>
 
 #include "ConfigManager.hpp"
 
+const char *BrowserWindowProcess::header = "Lprovider_snapshot";
+const quint32 BrowserWindowProcess::version = 5;
+
 BrowserWindowProcess::BrowserWindowProcess(QObject *parent)
     : QProcess(parent)
 {
@@ -26,15 +30,51 @@ void BrowserWindowProcess::start(const Provider &provider, OpenMode mode)
 {
     const QStringList arguments = ([&]{
         QStringList arguments = {
-            "--provider=" + provider.id
+            "--provider=" + provider.id,
+            "--provider-stdin"
         };
         if (Config()->fullScreenMode())
             arguments.append("-fs");
+        if (!Config()->recordTraceFile().isEmpty())
+            arguments.append("--record-trace=" + Config()->recordTraceFile());
         return arguments;
     })();
 
-    QProcess::start(QApplication::applicationFilePath(), arguments, mode);
+    QProcess::start(QApplication::applicationFilePath(), arguments, mode | WriteOnly);
     QProcess::waitForStarted();
+
+    BrowserWindowProcess::writeProvider(this, provider);
+    QProcess::closeWriteChannel();
+}
+
+bool BrowserWindowProcess::writeProvider(QIODevice *device, const Provider &provider)
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << QByteArray(BrowserWindowProcess::header) << BrowserWindowProcess::version << provider;
+    return stream.status() == QDataStream::Ok;
+}
+
+bool BrowserWindowProcess::readProvider(QIODevice *device, Provider *provider)
+{
+    const QByteArray data = device->readAll();
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    QByteArray magic;
+    quint32 snapshotVersion = 0;
+    stream >> magic >> snapshotVersion;
+    if (magic != BrowserWindowProcess::header || snapshotVersion != BrowserWindowProcess::version)
+        return false;
+
+    Provider snapshot;
+    stream >> snapshot;
+    if (stream.status() != QDataStream::Ok || snapshot.id.isEmpty())
+        return false;
+
+    (*provider) = snapshot;
+    return true;
 }
 
 void BrowserWindowProcess::_started()
@@ -15,6 +15,11 @@ public:
 
     void start(const Provider &provider, OpenMode mode = ReadOnly);
 
+    // pre-parsed provider handed over to the spawned instance on stdin,
+    // so the child doesn't need to parse the provider store again
+    static bool writeProvider(QIODevice *device, const Provider &provider);
+    static bool readProvider(QIODevice *device, Provider *provider);
+
 private slots:
     void _started();
     void _finished(int exitCode, ExitStatus exitStatus);
@@ -25,6 +30,9 @@ private slots:
 
 private:
     QMutex g_mutex;
+
+    static const char *header;
+    static const quint32 version;
 };
 
 #endif // BROWSERWINDOWPROCESS_HPP
@@ -51,6 +51,11 @@ ConfigManager::ConfigManager()
 #endif
 
     this->m_uiConfigFile = appConfigLocation + '/' + "ui_config.bin";
+    this->m_providerCacheFile = appConfigLocation + '/' + "provider_cache.bin";
+    this->m_iconCacheDir = appConfigLocation + '/' + "IconCache";
+    this->m_targetCacheDir = appConfigLocation + '/' + "TargetCache";
+    this->m_blockListFile = appConfigLocation + '/' + "blocklist.txt";
+    this->m_statisticsDir = appConfigLocation + '/' + "Statistics";
     this->readUiConfig();
 }
 
@@ -137,6 +142,31 @@ const QStringList &ConfigManager::providerStoreDirs() const
     return this->m_providerStoreDirs;
 }
 
+const QString &ConfigManager::providerCacheFile() const
+{
+    return this->m_providerCacheFile;
+}
+
+const QString &ConfigManager::iconCacheDir() const
+{
+    return this->m_iconCacheDir;
+}
+
+const QString &ConfigManager::targetCacheDir() const
+{
+    return this->m_targetCacheDir;
+}
+
+const QString &ConfigManager::blockListFile() const
+{
+    return this->m_blockListFile;
+}
+
+const QString &ConfigManager::statisticsDir() const
+{
+    return this->m_statisticsDir;
+}
+
 void ConfigManager::setMainWindowGeometry(const QRect &rect)
 {
     this->m_mainWindowGeometry = rect;
@@ -21,10 +21,29 @@ public:
     const QString &localProviderStoreDir() const;
     const QStringList &providerStoreDirs() const;
 
+    // Get binary provider cache file
+    const QString &providerCacheFile() const;
+
+    // Get rasterized icon cache directory
+    const QString &iconCacheDir() const;
+
+    // Get local copies of url interceptor targets directory
+    const QString &targetCacheDir() const;
+
+    // Get global block list file, applies to all providers
+    const QString &blockListFile() const;
+
+    // Get browser window statistics directory (interceptor rule hits and latency)
+    const QString &statisticsDir() const;
+
     // Startup profile to use, if empty display the main UI
     const QString &startupProfile() const { return this->m_startupProfile; }
     QString &startupProfile() { return this->m_startupProfile; }
 
+    // Record the requests of the browser window to this trace file, disabled if empty
+    const QString &recordTraceFile() const { return this->m_recordTraceFile; }
+    QString &recordTraceFile() { return this->m_recordTraceFile; }
+
     // What mode to use to display widgets
     const bool &fullScreenMode() const { return this->m_fullScreenMode; }
     bool &fullScreenMode() { return this->m_fullScreenMode; }
@@ -49,6 +68,7 @@ private:
     QStringList m_providerStoreDirs;
 
     QString m_startupProfile;
+    QString m_recordTraceFile;
     bool m_fullScreenMode = false;
     bool m_urlInterceptorEnabled = true;
 
@@ -57,6 +77,11 @@ private:
 
 private:
     QString m_uiConfigFile;
+    QString m_providerCacheFile;
+    QString m_iconCacheDir;
+    QString m_targetCacheDir;
+    QString m_blockListFile;
+    QString m_statisticsDir;
     bool readUiConfig();
     bool writeUiConfig();
 };
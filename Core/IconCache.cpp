@@ -0,0 +1,307 @@
+#include "IconCache.hpp"
+#include "ConfigManager.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <QSet>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QImageReader>
+#include <QPixmap>
+
+#include <cstring>
+
+#include <QDebug>
+
+const char *IconCache::header = "Licon_cache";
+const char *IconCache::indexHeader = "Licon_index";
+const quint32 IconCache::version = 1;
+
+QHash<QString, IconCache::FileStamp> IconCache::index;
+bool IconCache::indexLoaded = false;
+bool IconCache::indexDirty = false;
+QMutex IconCache::indexMutex;
+
+QImage IconCache::image(const QString &file, int size, qreal devicePixelRatio)
+{
+    const int pixels = qRound(size * devicePixelRatio);
+
+    const auto fileHash = IconCache::key(file);
+    if (fileHash.isEmpty())
+        return QImage();
+
+    const auto cacheFile = IconCache::cacheFile(fileHash, size, devicePixelRatio);
+
+    QImage image = IconCache::load(cacheFile);
+    if (image.isNull())
+    {
+        image = IconCache::rasterize(file, pixels);
+        if (image.isNull())
+            return QImage();
+
+        IconCache::save(cacheFile, image);
+    }
+
+    image.setDevicePixelRatio(devicePixelRatio);
+    return image;
+}
+
+QIcon IconCache::icon(const QString &file, const QList<int> &sizes, qreal devicePixelRatio)
+{
+    QIcon icon;
+    for (auto&& size : sizes)
+    {
+        const auto image = IconCache::image(file, size, devicePixelRatio);
+        if (!image.isNull())
+            icon.addPixmap(QPixmap::fromImage(image));
+    }
+    return icon;
+}
+
+QByteArray IconCache::hash(const QString &file)
+{
+    QFile in(file);
+    if (!in.open(QFile::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&in))
+        return QByteArray();
+
+    return hash.result().toHex();
+}
+
+QByteArray IconCache::key(const QString &file)
+{
+    const QFileInfo info(file);
+    const auto mtime = info.lastModified().toMSecsSinceEpoch();
+    const auto size = info.size();
+
+    {
+        QMutexLocker locker(&IconCache::indexMutex);
+        IconCache::loadIndex();
+
+        const auto it = IconCache::index.constFind(file);
+        if (it != IconCache::index.cend() && it->mtime == mtime && it->size == size)
+            return it->hash;
+    }
+
+    const auto fileHash = IconCache::hash(file);
+    if (fileHash.isEmpty())
+        return QByteArray();
+
+    // new or changed icon, written once all icons are loaded (see saveIndex())
+    QMutexLocker locker(&IconCache::indexMutex);
+    FileStamp stamp;
+    stamp.mtime = mtime;
+    stamp.size = size;
+    stamp.hash = fileHash;
+    IconCache::index.insert(file, stamp);
+    IconCache::indexDirty = true;
+
+    return fileHash;
+}
+
+void IconCache::prune(const QStringList &files)
+{
+    QSet<QString> hashes;
+    for (auto&& file : files)
+    {
+        const auto fileHash = IconCache::key(file);
+        if (!fileHash.isEmpty())
+            hashes.insert(QString::fromLatin1(fileHash));
+    }
+
+    {
+        const QSet<QString> referenced(files.cbegin(), files.cend());
+
+        QMutexLocker locker(&IconCache::indexMutex);
+        for (auto it = IconCache::index.begin(); it != IconCache::index.end();)
+        {
+            if (!referenced.contains(it.key()))
+            {
+                it = IconCache::index.erase(it);
+                IconCache::indexDirty = true;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (IconCache::indexDirty)
+            IconCache::writeIndex();
+    }
+
+    //  > {sha1}-{size}@{dpr}.bin
+    QDir dir(Config()->iconCacheDir());
+    const auto indexName = QFileInfo(IconCache::indexFile()).fileName();
+    auto removed = 0;
+    for (auto&& name : dir.entryList({"*.bin"}, QDir::Files))
+    {
+        if (name != indexName && !hashes.contains(name.section('-', 0, 0)) && dir.remove(name))
+            removed++;
+    }
+
+    if (removed > 0)
+        qDebug() << "Removed" << removed << "unused images from the icon cache";
+}
+
+QString IconCache::indexFile()
+{
+    return Config()->iconCacheDir() + '/' + "index.bin";
+}
+
+void IconCache::loadIndex()
+{
+    if (IconCache::indexLoaded)
+        return;
+    IconCache::indexLoaded = true;
+
+    QFile in(IconCache::indexFile());
+    if (!in.open(QFile::ReadOnly))
+        return;
+
+    QDataStream stream(&in);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    QByteArray magic;
+    quint32 indexVersion = 0, count = 0;
+    stream >> magic >> indexVersion >> count;
+    if (stream.status() != QDataStream::Ok || magic != IconCache::indexHeader || indexVersion != IconCache::version)
+        return;
+
+    for (quint32 i = 0; i < count; i++)
+    {
+        QString file;
+        FileStamp stamp;
+        stream >> file >> stamp.mtime >> stamp.size >> stamp.hash;
+
+        // a broken index only costs hashing the icons again
+        if (stream.status() != QDataStream::Ok)
+        {
+            IconCache::index.clear();
+            return;
+        }
+
+        IconCache::index.insert(file, stamp);
+    }
+}
+
+void IconCache::saveIndex()
+{
+    QMutexLocker locker(&IconCache::indexMutex);
+    if (IconCache::indexDirty)
+        IconCache::writeIndex();
+}
+
+bool IconCache::writeIndex()
+{
+    if (!QDir().mkpath(Config()->iconCacheDir()))
+        return false;
+
+    QSaveFile out(IconCache::indexFile());
+    if (!out.open(QFile::WriteOnly))
+        return false;
+
+    QDataStream stream(&out);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << QByteArray(IconCache::indexHeader) << IconCache::version << quint32(IconCache::index.size());
+    for (auto it = IconCache::index.cbegin(); it != IconCache::index.cend(); ++it)
+        stream << it.key() << it->mtime << it->size << it->hash;
+
+    if (stream.status() != QDataStream::Ok || !out.commit())
+    {
+        qDebug() << "Error writing the icon cache index" << IconCache::indexFile();
+        return false;
+    }
+
+    IconCache::indexDirty = false;
+    return true;
+}
+
+QString IconCache::cacheFile(const QByteArray &hash, int size, qreal devicePixelRatio)
+{
+    //  > {sha1}-{size}@{dpr}.bin
+    return Config()->iconCacheDir() + '/' + QString::fromLatin1(hash) + '-' +
+           QString::number(size) + '@' + QString::number(devicePixelRatio) + ".bin";
+}
+
+QImage IconCache::load(const QString &cacheFile)
+{
+    QFile cache(cacheFile);
+    if (!cache.open(QFile::ReadOnly))
+        return QImage();
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    QByteArray magic;
+    quint32 cacheVersion = 0;
+    qint32 width = 0, height = 0, bytesPerLine = 0;
+    QByteArray bits;
+    stream >> magic >> cacheVersion >> width >> height >> bytesPerLine >> bits;
+
+    if (stream.status() != QDataStream::Ok ||
+        magic != IconCache::header || cacheVersion != IconCache::version ||
+        width <= 0 || height <= 0)
+        return QImage();
+
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull() || image.bytesPerLine() != bytesPerLine || image.sizeInBytes() != bits.size())
+        return QImage();
+
+    std::memcpy(image.bits(), bits.constData(), std::size_t(bits.size()));
+    return image;
+}
+
+bool IconCache::save(const QString &cacheFile, const QImage &image)
+{
+    if (!QDir().mkpath(Config()->iconCacheDir()))
+        return false;
+
+    QSaveFile cache(cacheFile);
+    if (!cache.open(QFile::WriteOnly))
+        return false;
+
+    const auto premultiplied = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << QByteArray(IconCache::header) << IconCache::version
+           << qint32(premultiplied.width()) << qint32(premultiplied.height()) << qint32(premultiplied.bytesPerLine())
+           << QByteArray::fromRawData(reinterpret_cast<const char*>(premultiplied.constBits()), int(premultiplied.sizeInBytes()));
+
+    if (stream.status() != QDataStream::Ok || !cache.commit())
+    {
+        qDebug() << "Error writing the icon cache" << cacheFile;
+        return false;
+    }
+
+    return true;
+}
+
+QImage IconCache::rasterize(const QString &file, int pixels)
+{
+    QImageReader reader(file);
+    const QSize original = reader.size();
+    if (original.isValid())
+        reader.setScaledSize(original.scaled(pixels, pixels, Qt::KeepAspectRatio));
+
+    QImage image = reader.read();
+    if (image.isNull())
+    {
+        qDebug() << "Unable to decode icon" << file << reader.errorString();
+        return QImage();
+    }
+
+    // format doesn't support scaled reads
+    if (image.width() > pixels || image.height() > pixels)
+        image = image.scaled(pixels, pixels, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
@@ -0,0 +1,75 @@
+#ifndef ICONCACHE_HPP
+#define ICONCACHE_HPP
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+#include <QImage>
+#include <QIcon>
+
+// On-disk cache of rasterized icons, keyed by the content hash of the icon file,
+// the target size and the device pixel ratio. Images are stored as raw
+// premultiplied ARGB32 pixels, so a cache hit doesn't decode anything.
+// The content hash is remembered together with the mtime and size of the icon file
+// (index.bin), the file is only read and hashed again when one of them changed.
+// New hashes are only kept in memory until saveIndex() or prune() is called.
+class IconCache
+{
+    IconCache() {}
+
+public:
+
+    // Rasterized icon at the given size (device independent pixels, aspect preserving).
+    // Rasterizes and stores the icon on a cache miss. Thread-safe.
+    static QImage image(const QString &file, int size, qreal devicePixelRatio);
+
+    // Icon with pixmaps for all the given sizes, GUI thread only.
+    // Returns a null icon if the file can't be rasterized.
+    static QIcon icon(const QString &file, const QList<int> &sizes, qreal devicePixelRatio);
+
+    // SHA1 of the file content, empty if the file can't be read
+    static QByteArray hash(const QString &file);
+
+    // Remembered hash of the file while its mtime and size didn't change,
+    // otherwise the hash of the file content. Thread-safe.
+    static QByteArray key(const QString &file);
+
+    // Remove the cached images and index entries of all icon files not in the list.
+    // Saves the index.
+    static void prune(const QStringList &files);
+
+    // Write the index if hashes were added since it was loaded or saved. Thread-safe.
+    static void saveIndex();
+
+private:
+    static QString cacheFile(const QByteArray &hash, int size, qreal devicePixelRatio);
+    static QImage load(const QString &cacheFile);
+    static bool save(const QString &cacheFile, const QImage &image);
+    static QImage rasterize(const QString &file, int pixels);
+
+    struct FileStamp
+    {
+        qint64 mtime = 0;
+        qint64 size = 0;
+        QByteArray hash;
+    };
+
+    // index file -> stamp, loaded on first use, guarded by indexMutex
+    static QHash<QString, FileStamp> index;
+    static bool indexLoaded;
+    static bool indexDirty;
+    static QMutex indexMutex;
+
+    static QString indexFile();
+    static void loadIndex();
+    static bool writeIndex();
+
+    static const char *header;
+    static const char *indexHeader;
+    static const quint32 version;
+};
+
+#endif // ICONCACHE_HPP
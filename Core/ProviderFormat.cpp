@@ -0,0 +1,172 @@
+#include "ProviderFormat.hpp"
+
+#include <cstring>
+
+namespace ProviderFormat
+{
+
+static constexpr Keyword keys[] = {
+    {"name",                       int(Key::Name)},
+    {"icon",                       int(Key::Icon)},
+    {"url",                        int(Key::Url)},
+    {"urlInterceptor",             int(Key::UrlInterceptor)},
+    {"urlInterceptorPattern",      int(Key::UrlInterceptorPattern)},
+    {"urlInterceptorTarget",       int(Key::UrlInterceptorTarget)},
+    {"urlInterceptorMatch",        int(Key::UrlInterceptorMatch)},
+    {"urlInterceptorResourceTypes", int(Key::UrlInterceptorResourceTypes)},
+    {"user-agent",                 int(Key::UserAgent)},
+    {"titlebar",                   int(Key::TitleBar)},
+    {"titlebar-text",              int(Key::TitleBarText)},
+    {"titlebar-color",             int(Key::TitleBarColor)},
+    {"titlebar-text-color",        int(Key::TitleBarTextColor)},
+    {"script",                     int(Key::Script)},
+    {"httpAcceptLanguage",         int(Key::HttpAcceptLanguage)},
+    {"httpHeader",                 int(Key::HttpHeader)},
+    {"block",                      int(Key::Block)},
+    {"blockList",                  int(Key::BlockList)},
+};
+
+static inline bool isSpace(char c)
+{
+    // ASCII subset of QChar::isSpace()
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline char toLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+int lookup(const Keyword *table, int count, const char *word, int size, int fallback)
+{
+    for (auto i = 0; i < count; i++)
+    {
+        const auto &keyword = table[i];
+        if (keyword.size != size)
+            continue;
+
+        auto c = 0;
+        while (c < size && toLower(word[c]) == toLower(keyword.name[c]))
+            c++;
+        if (c == size)
+            return keyword.value;
+    }
+
+    return fallback;
+}
+
+int lookup(const Keyword *table, int count, const QStringRef &word, int fallback)
+{
+    for (auto i = 0; i < count; i++)
+    {
+        const auto &keyword = table[i];
+        if (keyword.size != word.size())
+            continue;
+
+        auto c = 0;
+        while (c < keyword.size &&
+               word.at(c).unicode() < 0x80 &&
+               toLower(char(word.at(c).unicode())) == toLower(keyword.name[c]))
+            c++;
+        if (c == keyword.size)
+            return keyword.value;
+    }
+
+    return fallback;
+}
+
+ByteView ByteView::trimmed() const
+{
+    auto begin = this->data;
+    auto end = this->data + this->size;
+    while (begin < end && isSpace(*begin))
+        ++begin;
+    while (end > begin && isSpace(*(end - 1)))
+        --end;
+    return ByteView{begin, int(end - begin)};
+}
+
+QString ByteView::toString() const
+{
+    // plain ASCII values without whitespace runs are already simplified
+    const auto view = this->trimmed();
+    for (auto i = 0; i < view.size; i++)
+    {
+        const auto c = view.data[i];
+        if ((c & 0x80) || (isSpace(c) && (c != ' ' || isSpace(view.data[i + 1]))))
+            return QString::fromUtf8(view.data, view.size).simplified();
+    }
+
+    return QString::fromUtf8(view.data, view.size);
+}
+
+Tokenizer::Tokenizer(const char *data, int size)
+    : m_pos(data), m_end(data + size)
+{
+}
+
+Tokenizer::Tokenizer(const QByteArray &data)
+    : Tokenizer(data.constData(), data.size())
+{
+}
+
+bool Tokenizer::next(Token *token)
+{
+    while (this->m_pos < this->m_end)
+    {
+        const auto begin = this->m_pos;
+        auto eol = begin;
+        while (eol < this->m_end && *eol != '\n' && *eol != '\r')
+            ++eol;
+
+        this->m_pos = eol;
+        while (this->m_pos < this->m_end && (*this->m_pos == '\n' || *this->m_pos == '\r'))
+            ++this->m_pos;
+
+        // empty line or comment
+        if (eol == begin || *begin == '#')
+            continue;
+
+        token->line = ByteView{begin, int(eol - begin)};
+
+        const auto colon = static_cast<const char*>(std::memchr(begin, ':', std::size_t(eol - begin)));
+        if (colon)
+        {
+            token->key = ProviderFormat::key(begin, int(colon - begin));
+            token->value = ByteView{colon + 1, int(eol - colon - 1)}.trimmed();
+        }
+        else
+        {
+            token->key = Key::Unknown;
+            token->value = ByteView();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+Key key(const char *name, int size)
+{
+    return static_cast<Key>(lookup(keys, int(sizeof(keys) / sizeof(keys[0])), name, size, int(Key::Unknown)));
+}
+
+Key key(const QString &line)
+{
+    const auto colon = line.indexOf(':');
+    if (colon == -1)
+        return Key::Unknown;
+
+    return static_cast<Key>(lookup(keys, line.leftRef(colon), int(Key::Unknown)));
+}
+
+const char *name(Key key)
+{
+    for (auto&& keyword : keys)
+        if (keyword.value == int(key))
+            return keyword.name;
+    return "";
+}
+
+}
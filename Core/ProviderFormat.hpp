@@ -0,0 +1,102 @@
+#ifndef PROVIDERFORMAT_HPP
+#define PROVIDERFORMAT_HPP
+
+#include <QString>
+#include <QStringRef>
+#include <QByteArray>
+
+// Tokenizer and key table for the "key:value" provider file format.
+namespace ProviderFormat
+{
+
+enum class Key {
+    Unknown,
+    Name,
+    Icon,
+    Url,
+    UrlInterceptor,
+    UrlInterceptorPattern,
+    UrlInterceptorTarget,
+    UrlInterceptorMatch,
+    UrlInterceptorResourceTypes,
+    UserAgent,
+    TitleBar,
+    TitleBarText,
+    TitleBarColor,
+    TitleBarTextColor,
+    Script,
+    HttpAcceptLanguage,
+    HttpHeader,
+    Block,
+    BlockList,
+};
+
+// Entry of a compile-time keyword table, matched case-insensitive.
+struct Keyword
+{
+    template<int N>
+    constexpr Keyword(const char (&name)[N], int value)
+        : name(name), size(N - 1), value(value)
+    {}
+
+    const char *name;
+    int size;
+    int value;
+};
+
+int lookup(const Keyword *table, int count, const char *word, int size, int fallback);
+int lookup(const Keyword *table, int count, const QStringRef &word, int fallback);
+
+template<int N>
+inline int lookup(const Keyword (&table)[N], const QStringRef &word, int fallback)
+{ return lookup(table, N, word, fallback); }
+
+// Non-owning view into raw file data.
+struct ByteView
+{
+    const char *data = nullptr;
+    int size = 0;
+
+    inline bool isEmpty() const { return this->size == 0; }
+
+    ByteView trimmed() const;
+
+    // decode as UTF-8, same result as QString::simplified()
+    // but without the intermediate copies for plain values
+    QString toString() const;
+};
+
+struct Token
+{
+    Key key = Key::Unknown;
+    ByteView line;
+    ByteView value; // trimmed
+};
+
+// Single pass over the raw bytes of a provider file.
+// Empty lines and comments are skipped.
+class Tokenizer
+{
+public:
+    Tokenizer(const char *data, int size);
+    explicit Tokenizer(const QByteArray &data);
+
+    bool next(Token *token);
+
+private:
+    const char *m_pos;
+    const char *m_end;
+};
+
+// key of a raw key name (without colon)
+Key key(const char *name, int size);
+
+// key of a "key:value" line
+Key key(const QString &line);
+
+// canonical spelling of the key
+const char *name(Key key);
+
+}
+
+#endif // PROVIDERFORMAT_HPP
@@ -0,0 +1,115 @@
+#include "ProviderIconLoader.hpp"
+#include "StreamingProviderParser.hpp"
+#include "StreamingProviderWatcher.hpp"
+#include "IconCache.hpp"
+
+#include <QApplication>
+#include <QPixmap>
+
+#include <QtConcurrent>
+
+#include <QDebug>
+
+const int ProviderIconLoader::buttonIconSize = 80;
+const int ProviderIconLoader::titleBarIconSize = 23;
+
+ProviderIconLoader *ProviderIconLoader::instance()
+{
+    static ProviderIconLoader *i = new ProviderIconLoader();
+    return i;
+}
+
+ProviderIconLoader::ProviderIconLoader()
+{
+}
+
+ProviderIconLoader::~ProviderIconLoader()
+{
+}
+
+void ProviderIconLoader::loadAll()
+{
+    for (auto&& provider : StreamingProviderStore::instance()->providers())
+        this->load(provider);
+}
+
+void ProviderIconLoader::load(const Provider &provider)
+{
+    if (provider.id.isEmpty() || provider.icon.value.isEmpty())
+        return;
+
+    const DecodedIcon request{
+        provider.id,
+        provider.icon.value,
+        StreamingProviderParser::iconFile(provider.icon.value, provider.path),
+        {}
+    };
+
+    // rasterize for the screen with the highest pixel density
+    const qreal devicePixelRatio = qApp->devicePixelRatio();
+
+    this->m_pending++;
+    QtConcurrent::run([=]{
+        const auto icon = ProviderIconLoader::decode(request, devicePixelRatio);
+
+        // QPixmap and the store are GUI thread only
+        QMetaObject::invokeMethod(ProviderIconLoader::instance(), [=]{
+            const auto loader = ProviderIconLoader::instance();
+            loader->apply(icon);
+            if (--loader->m_pending == 0)
+                IconCache::saveIndex();
+        }, Qt::QueuedConnection);
+    });
+}
+
+QStringList ProviderIconLoader::iconFiles()
+{
+    QStringList files;
+    for (auto&& provider : StreamingProviderStore::instance()->providers())
+    {
+        if (!provider.icon.value.isEmpty())
+            files.append(StreamingProviderParser::iconFile(provider.icon.value, provider.path));
+    }
+    return files;
+}
+
+ProviderIconLoader::DecodedIcon ProviderIconLoader::decode(const DecodedIcon &request, qreal devicePixelRatio)
+{
+    DecodedIcon icon = request;
+
+    for (auto&& size : {ProviderIconLoader::buttonIconSize, ProviderIconLoader::titleBarIconSize})
+    {
+        const auto image = IconCache::image(icon.file, size, devicePixelRatio);
+        if (image.isNull())
+            break;
+        icon.images.append(image);
+    }
+
+    return icon;
+}
+
+void ProviderIconLoader::apply(const DecodedIcon &icon)
+{
+    const auto store = StreamingProviderStore::instance();
+    if (!store->contains(icon.id))
+        return;
+
+    // icon was changed while decoding, a newer request is pending
+    Provider provider = store->provider(icon.id);
+    if (provider.icon.value != icon.value ||
+        StreamingProviderParser::iconFile(provider.icon.value, provider.path) != icon.file)
+        return;
+
+    QIcon decoded;
+    for (auto&& image : icon.images)
+        decoded.addPixmap(QPixmap::fromImage(image));
+
+    // no image plugin for this file, let QIcon deal with it on demand
+    if (decoded.isNull())
+        decoded = QIcon(icon.file);
+
+    provider.icon.icon = decoded;
+    StreamingProviderWatcher::instance()->updateProvider(icon.id, provider);
+
+    emit iconLoaded(icon.id, decoded);
+}
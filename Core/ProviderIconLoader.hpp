@@ -0,0 +1,58 @@
+#ifndef PROVIDERICONLOADER_HPP
+#define PROVIDERICONLOADER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QStringList>
+#include <QImage>
+#include <QIcon>
+
+#include "StreamingProviderStore.hpp"
+
+// Decodes provider icons on the global thread pool (see IconCache).
+// Providers show their name until the icon is ready, the store
+// is updated through the StreamingProviderWatcher afterwards.
+class ProviderIconLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ProviderIconLoader *instance();
+    ~ProviderIconLoader();
+
+    // icon sizes as used by ProviderButton and the BrowserWindow title bar
+    static const int buttonIconSize;
+    static const int titleBarIconSize;
+
+    // decode the icons of all providers in the store
+    void loadAll();
+
+    // decode the icon of the given provider
+    void load(const Provider &provider);
+
+    // icon files of all providers in the store
+    static QStringList iconFiles();
+
+signals:
+    void iconLoaded(const QString &id, const QIcon &icon);
+
+private:
+    ProviderIconLoader();
+
+    struct DecodedIcon
+    {
+        QString id;
+        QString value;
+        QString file;
+        QList<QImage> images;
+    };
+
+    static DecodedIcon decode(const DecodedIcon &request, qreal devicePixelRatio);
+    void apply(const DecodedIcon &icon);
+
+    // decodes still running, the icon cache index is saved when the last one is done
+    int m_pending = 0;
+};
+
+#endif // PROVIDERICONLOADER_HPP
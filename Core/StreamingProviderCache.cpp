@@ -0,0 +1,143 @@
+#include "StreamingProviderCache.hpp"
+#include "StreamingProviderStore.hpp"
+#include "ConfigManager.hpp"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QByteArray>
+#include <QDataStream>
+
+#include <QDebug>
+
+const char *StreamingProviderCache::header = "Lprovider_cache";
+const quint32 StreamingProviderCache::version = 5;
+
+static void writeFileStamps(QDataStream &stream, const QStringList &providerFiles)
+{
+    stream << quint32(providerFiles.size());
+    for (auto&& file : providerFiles)
+    {
+        const QFileInfo info(file);
+        stream << file << info.lastModified().toMSecsSinceEpoch() << info.size();
+    }
+}
+
+static bool validateFileStamps(QDataStream &stream, const QStringList &providerFiles)
+{
+    quint32 count = 0;
+    stream >> count;
+    if (count != quint32(providerFiles.size()))
+        return false;
+
+    for (auto&& file : providerFiles)
+    {
+        QString path;
+        qint64 mtime = 0, size = 0;
+        stream >> path >> mtime >> size;
+        if (stream.status() != QDataStream::Ok || path != file)
+            return false;
+
+        const QFileInfo info(file);
+        if (info.lastModified().toMSecsSinceEpoch() != mtime || info.size() != size)
+            return false;
+    }
+
+    return true;
+}
+
+bool StreamingProviderCache::load(const QStringList &providerFiles)
+{
+    QFile cache(Config()->providerCacheFile());
+    if (!cache.exists() || !cache.open(QFile::ReadOnly))
+        return false;
+
+    // map the snapshot into memory, fall back to a regular read if that fails
+    const qint64 size = cache.size();
+    uchar *mapped = size > 0 ? cache.map(0, size) : nullptr;
+
+    QList<Provider> providers;
+    const bool valid = ([&]{
+        const QByteArray data = mapped ?
+            QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), int(size)) :
+            cache.readAll();
+
+        QDataStream stream(data);
+        stream.setVersion(QDataStream::Qt_5_9);
+
+        QByteArray magic;
+        quint32 cacheVersion = 0;
+        stream >> magic >> cacheVersion;
+        if (magic != StreamingProviderCache::header || cacheVersion != StreamingProviderCache::version)
+        {
+            qDebug() << "Provider cache has an unknown format. Ignoring...";
+            return false;
+        }
+
+        QStringList storeDirs;
+        stream >> storeDirs;
+        if (storeDirs != Config()->providerStoreDirs())
+            return false;
+
+        if (!validateFileStamps(stream, providerFiles))
+        {
+            qDebug() << "Provider cache is outdated.";
+            return false;
+        }
+
+        quint32 count = 0;
+        stream >> count;
+        for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+        {
+            Provider provider;
+            stream >> provider;
+            providers.append(provider);
+        }
+
+        return stream.status() == QDataStream::Ok;
+    })();
+
+    if (mapped)
+        cache.unmap(mapped);
+    cache.close();
+
+    if (!valid)
+        return false;
+
+    StreamingProviderStore::instance()->addProviders(providers);
+
+    qDebug() << "Loaded" << providers.size() << "providers from the provider cache.";
+    return true;
+}
+
+bool StreamingProviderCache::save(const QStringList &providerFiles)
+{
+    QSaveFile cache(Config()->providerCacheFile());
+    if (!cache.open(QFile::WriteOnly))
+    {
+        qDebug() << "Error writing the provider cache!";
+        return false;
+    }
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << QByteArray(StreamingProviderCache::header) << StreamingProviderCache::version;
+    stream << Config()->providerStoreDirs();
+    writeFileStamps(stream, providerFiles);
+
+    const auto &providers = StreamingProviderStore::instance()->providers();
+    stream << quint32(providers.size());
+    for (auto&& provider : providers)
+        stream << provider;
+
+    if (stream.status() != QDataStream::Ok || !cache.commit())
+    {
+        qDebug() << "Error writing the provider cache!";
+        return false;
+    }
+
+    qDebug() << "Provider cache written!";
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef STREAMINGPROVIDERCACHE_HPP
+#define STREAMINGPROVIDERCACHE_HPP
+
+#include <QString>
+#include <QStringList>
+
+class StreamingProviderCache
+{
+    StreamingProviderCache() {}
+
+public:
+
+    // Load the provider snapshot into the StreamingProviderStore.
+    // Returns false if the cache is missing, outdated or doesn't match
+    // the given provider files (path, mtime or size changed).
+    static bool load(const QStringList &providerFiles);
+
+    // Write the current content of the StreamingProviderStore to the cache,
+    // validated against the given provider files on the next load.
+    static bool save(const QStringList &providerFiles);
+
+private:
+    static const char *header;
+    static const quint32 version;
+};
+
+#endif // STREAMINGPROVIDERCACHE_HPP
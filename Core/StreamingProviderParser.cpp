@@ -1,5 +1,8 @@
 #include "StreamingProviderParser.hpp"
 #include "StreamingProviderStore.hpp"
+#include "ProviderFormat.hpp"
+#include "ProviderIconLoader.hpp"
+#include "IconCache.hpp"
 
 #include <QApplication>
 #include <QStandardPaths>
@@ -10,6 +13,9 @@
 #include <QByteArray>
 #include <QRegExp>
 #include <QColor>
+#include <QHash>
+
+#include <QtConcurrent>
 
 #include <QDebug>
 
@@ -27,19 +33,34 @@ StreamingProviderParser::~StreamingProviderParser()
 }
 
 void StreamingProviderParser::findAll()
+{
+    this->find(StreamingProviderParser::search_pattern);
+}
+
+void StreamingProviderParser::findProvider(const QString &provider_name)
+{
+    // the name may contain wildcard characters, compared as is
+    this->find(StreamingProviderParser::search_pattern,
+               StreamingProviderParser::baseName(provider_name) + StreamingProviderParser::extension);
+}
+
+void StreamingProviderParser::find(const QString &pattern, const QString &fileName)
 {
     for (auto&& path : this->m_validPaths)
     {
         QStringList currentPaths;
 
         QDirIterator providers(path,
-                               QStringList{StreamingProviderParser::search_pattern},
+                               QStringList{pattern},
                                QDir::Files | QDir::Readable | QDir::NoDotAndDotDot,
                                QDirIterator::FollowSymlinks | QDirIterator::Subdirectories);
         while (providers.hasNext())
         {
             (void) providers.next();
 
+            if (!fileName.isEmpty() && providers.fileName() != fileName)
+                continue;
+
             const auto provider_file = providers.fileInfo().absoluteFilePath();
             currentPaths.append(provider_file);
         }
@@ -47,6 +68,25 @@ void StreamingProviderParser::findAll()
         currentPaths.sort();
         this->m_providers.append(currentPaths);
     }
+
+    // index the highest priority file of every provider
+    // later store paths override earlier ones
+    QStringList ids;
+    for (auto&& provider_file : this->m_providers)
+    {
+        const auto id = StreamingProviderParser::baseName(provider_file);
+
+        // skip files with dots in their base name, e.g. "name.suffix.p"
+        if (!provider_file.endsWith('/' + id + StreamingProviderParser::extension))
+            continue;
+
+        if (!this->m_highestPriority.contains(id))
+            ids.append(id);
+        this->m_highestPriority.insert(id, provider_file);
+    }
+
+    for (auto&& id : ids)
+        this->m_effectiveProviders.append(this->m_highestPriority.value(id));
 }
 
 StreamingProviderParser::StatusCode StreamingProviderParser::parse(const QString &provider_name) const
@@ -55,35 +95,110 @@ StreamingProviderParser::StatusCode StreamingProviderParser::parse(const QString
     if (provider_file.isEmpty())
         return FILE_ERROR;
 
-    if (StreamingProviderStore::instance()->contains(QFileInfo(provider_name).baseName()))
+    if (StreamingProviderStore::instance()->contains(StreamingProviderParser::baseName(provider_name)))
         return ALREADY_IN_LIST;
 
-    const auto provider_path = QFileInfo(provider_file).path();
+    Provider provider;
+    const auto status = StreamingProviderParser::parseFile(provider_file, &provider);
+    if (status != SUCCESS)
+        return status;
 
-    QFile file(provider_file);
-    QString data;
-    if (file.open(QFile::ReadOnly | QFile::Text))
+    StreamingProviderStore::instance()->addProvider(provider);
+
+    return SUCCESS;
+}
+
+struct ParsedFile
+{
+    StreamingProviderParser::StatusCode status;
+    Provider provider;
+};
+
+static ParsedFile parseStandalone(const QString &provider_file)
+{
+    ParsedFile parsed;
+    parsed.status = StreamingProviderParser::parseFile(provider_file, &parsed.provider);
+    return parsed;
+}
+
+QList<StreamingProviderParser::ParseResult> StreamingProviderParser::parseAll(bool parallel) const
+{
+    const auto &files = this->m_effectiveProviders;
+
+    const QList<ParsedFile> parsed = parallel ?
+        QtConcurrent::blockingMapped<QList<ParsedFile>>(files, parseStandalone) :
+        ([&]{
+            QList<ParsedFile> result;
+            for (auto&& file : files)
+                result.append(parseStandalone(file));
+            return result;
+        })();
+
+    QHash<QString, int> index;
+    for (auto i = 0; i < files.size(); i++)
+        index.insert(files.at(i), i);
+
+    // merge in priority order, same semantics as calling parse() for every provider
+    QList<ParseResult> results;
+    for (auto&& i : this->m_providers)
     {
-        data = file.readAll();
-        file.close();
+        const auto provider_file = this->findHighestPriorityProvider(i);
+
+        StatusCode status;
+        if (provider_file.isEmpty())
+        {
+            status = FILE_ERROR;
+        }
+        else if (StreamingProviderStore::instance()->contains(StreamingProviderParser::baseName(i)))
+        {
+            status = ALREADY_IN_LIST;
+        }
+        else
+        {
+            const auto &file = parsed.at(index.value(provider_file));
+            status = file.status;
+            if (status == SUCCESS)
+                StreamingProviderStore::instance()->addProvider(file.provider);
+        }
+
+        results.append(ParseResult{i, status});
     }
-    else
+
+    StreamingProviderStore::instance()->sort();
+
+    return results;
+}
+
+StreamingProviderParser::StatusCode StreamingProviderParser::parseFile(const QString &provider_file, Provider *provider_out)
+{
+    if (!provider_out)
+        return FILE_ERROR;
+
+    const auto provider_path = QFileInfo(provider_file).path();
+
+    // map the file into memory and tokenize the raw bytes,
+    // only the values end up as QString
+    QFile file(provider_file);
+    if (!file.open(QFile::ReadOnly))
     {
         qDebug() << provider_file << "Unable to open file for reading!";
         return FILE_ERROR;
     }
 
+    const auto size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    const QByteArray data = mapped ?
+        QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), int(size)) :
+        file.readAll();
+
     if (data.isEmpty())
     {
         qDebug() << provider_file << "File is empty!";
         return FILE_EMPTY;
     }
 
-    QStringList props = data.split(QRegExp("[\r\n]"), Qt::SkipEmptyParts);
-    data.clear();
-
     Provider provider;
-    provider.id = QFileInfo(provider_file).baseName();
+    provider.id = StreamingProviderParser::baseName(provider_file);
     provider.path = provider_path;
     if (provider_path == Config()->localProviderStoreDir())
         provider.isSystem = false;
@@ -93,125 +208,199 @@ StreamingProviderParser::StatusCode StreamingProviderParser::parse(const QString
     qDebug() << "is shared (system-installed)?:" << (provider.isSystem ? "yes" : "no");
     bool hasErrors = false;
 
-    for (auto&& i : props)
+    ProviderFormat::Tokenizer tokenizer(data);
+    ProviderFormat::Token i;
+    while (tokenizer.next(&i))
     {
-        // comment line
-        if (i.startsWith('#'))
-            continue;
-
-        // provider name
-        else if (i.startsWith("name:", Qt::CaseInsensitive))
-            provider.name = i.mid(5).simplified();
-
-        // provider icon
-        else if (i.startsWith("icon:", Qt::CaseInsensitive))
+        switch (i.key)
         {
-            const auto icon = i.mid(5).simplified();
-
-            if (!icon.isEmpty())
+            // provider name
+            case ProviderFormat::Key::Name:
+                provider.name = i.value.toString();
+                break;
+
+            // provider icon, loaded later on (see ProviderIconLoader)
+            case ProviderFormat::Key::Icon:
+                provider.icon.value = i.value.toString();
+                break;
+
+            // provider url
+            case ProviderFormat::Key::Url:
+                provider.url = QUrl(i.value.toString());
+                break;
+
+            // use url interceptor?
+            case ProviderFormat::Key::UrlInterceptor:
+                provider.urlInterceptor = getBoolean(i.value.toString());
+                break;
+
+            // http user-agent
+            case ProviderFormat::Key::UserAgent:
+                provider.useragent = i.value.toString();
+                break;
+
+            // should render titlebar?
+            case ProviderFormat::Key::TitleBar:
+                provider.titleBarVisible = getBoolean(i.value.toString());
+                break;
+
+            // titlebar color
+            case ProviderFormat::Key::TitleBarColor:
+                provider.titleBarColor = getColor(i.value.toString(), provider.titleBarColor);
+                break;
+
+            // titlebar text color
+            case ProviderFormat::Key::TitleBarTextColor:
+                provider.titleBarTextColor = getColor(i.value.toString(), provider.titleBarTextColor);
+                break;
+
+            // permanent titlebar text
+            case ProviderFormat::Key::TitleBarText:
+                provider.titleBarHasPermanentTitle = true;
+                provider.titleBarPermanentTitle = i.value.toString();
+                break;
+
+            // url interceptor pattern and target url
+            case ProviderFormat::Key::UrlInterceptorPattern:
             {
-                StreamingProviderParser::parseIcon(icon, &provider.icon.value, &provider.icon.icon, provider_path);
+                const auto pattern = i.value.toString();
+                provider.urlInterceptorLinks.append(UrlInterceptorLink{QRegExp(pattern), QUrl()});
+                qDebug() << provider_file << "Found URL Interceptor Pattern:" << pattern;
+                break;
+            }
+            case ProviderFormat::Key::UrlInterceptorMatch:
+            {
+                const auto match = UrlMatch::parse(i.value.toString());
+                if (match.isValid())
+                {
+                    provider.urlInterceptorLinks.append(UrlInterceptorLink{QRegExp(), QUrl(), match});
+                    qDebug() << provider_file << "Found URL Interceptor Match:" << QString(match);
+                }
+                else
+                {
+                    // same as an invalid pattern, the following target would belong to no rule
+                    qDebug() << provider_file << "Invalid URL Interceptor Match:" << i.value.toString();
+                    hasErrors = true;
+                }
+                break;
+            }
+            case ProviderFormat::Key::UrlInterceptorTarget:
+            {
+                const auto target = i.value.toString();
+                if (provider.urlInterceptorLinks.size() != 0 &&
+                    provider.urlInterceptorLinks.last().hasRule() &&
+                    provider.urlInterceptorLinks.last().target.isEmpty())
+                {
+                    // a match has no capture groups, the reference would silently become empty
+                    if (provider.urlInterceptorLinks.last().match.isValid() &&
+                        UrlInterceptorLink::hasCaptureReferences(QUrl(target)))
+                    {
+                        qDebug() << provider_file << "URL Interceptor Match targets can't refer to capture groups:" << target;
+                        hasErrors = true;
+                    }
+                    provider.urlInterceptorLinks.last().target = QUrl(target);
+                    qDebug() << provider_file << "Added new target for pattern:" << target;
+                }
+                else
+                {
+                    qDebug() << provider_file << "Missing pattern or target for last pattern!";
+                }
+                break;
             }
-        }
-
-        // provider url
-        else if (i.startsWith("url:", Qt::CaseInsensitive))
-            provider.url  = QUrl(i.mid(4).simplified());
-
-        // use url interceptor?
-        else if (i.startsWith("urlInterceptor:", Qt::CaseInsensitive))
-            provider.urlInterceptor = getBoolean(i.mid(15).simplified());
-
-        // http user-agent
-        else if (i.startsWith("user-agent:", Qt::CaseInsensitive))
-            provider.useragent = i.mid(11).simplified();
-
-        // should render titlebar?
-        else if (i.startsWith("titlebar:", Qt::CaseInsensitive))
-            provider.titleBarVisible = getBoolean(i.mid(9).simplified());
-
-        // titlebar color
-        else if (i.startsWith("titlebar-color:", Qt::CaseInsensitive))
-            provider.titleBarColor = getColor(i.mid(15).simplified(), provider.titleBarColor);
-
-        // titlebar text color
-        else if (i.startsWith("titlebar-text-color:", Qt::CaseInsensitive))
-            provider.titleBarTextColor = getColor(i.mid(20).simplified(), provider.titleBarTextColor);
-
-        // permanent titlebar text
-        else if (i.startsWith("titlebar-text:", Qt::CaseInsensitive))
-        {
-            provider.titleBarHasPermanentTitle = true;
-            provider.titleBarPermanentTitle = i.mid(14).simplified();
-        }
 
-        // url interceptor pattern and target url
-        else if (i.startsWith("urlInterceptorPattern:", Qt::CaseInsensitive))
-        {
-            const auto pattern = i.mid(22).simplified();
-            provider.urlInterceptorLinks.append(UrlInterceptorLink{QRegExp(pattern), QUrl()});
-            qDebug() << provider_file << "Found URL Interceptor Pattern:" << pattern;
-        }
-        else if (i.startsWith("urlInterceptorTarget:", Qt::CaseInsensitive))
-        {
-            const auto target = i.mid(21).simplified();
-            if (provider.urlInterceptorLinks.size() != 0 &&
-                !provider.urlInterceptorLinks.last().pattern.isEmpty() &&
-                provider.urlInterceptorLinks.last().target.isEmpty())
+            case ProviderFormat::Key::UrlInterceptorResourceTypes:
             {
-                provider.urlInterceptorLinks.last().target = QUrl(target);
-                qDebug() << provider_file << "Added new target for pattern:" << target;
+                if (provider.urlInterceptorLinks.size() != 0 &&
+                    provider.urlInterceptorLinks.last().hasRule())
+                {
+                    provider.urlInterceptorLinks.last().resourceTypes = UrlInterceptorLink::parseResourceTypes(i.value.toString());
+                    qDebug() << provider_file << "Restricted last rule to resource types:" << i.value.toString();
+                }
+                else
+                {
+                    qDebug() << provider_file << "Missing pattern for resource types!";
+                }
+                break;
             }
-            else
+
+            // script / userscript
+            case ProviderFormat::Key::Script:
             {
-                qDebug() << provider_file << "Missing pattern or target for last pattern!";
+                const auto script = Script::parse(i.value.toString());
+
+                static const auto contains_script = [&](const QList<Script> &scripts, const Script &script) {
+                    for (auto&& scr : scripts)
+                        if (scr.filename == script.filename)
+                            return true;
+                    return false;
+                };
+
+                if (!contains_script(provider.scripts, script))
+                {
+                    provider.scripts.append(script);
+                    qDebug() << provider_file << "Loaded script" << script.filename << "with mode" << script.injectionPoint;
+                }
+                else
+                {
+                    qDebug() << provider_file << "Warning: Duplicate 'script' skipped ->" << script;
+                }
+                break;
             }
-        }
 
-        // script / userscript
-        else if (i.startsWith("script:", Qt::CaseInsensitive))
-        {
-            const auto _script = i.mid(7).simplified();
-            const auto script = Script::parse(_script);
+            // http accept-language header
+            case ProviderFormat::Key::HttpAcceptLanguage:
+                provider.httpAcceptLanguage = i.value.toString();
+                break;
 
-            static const auto contains_script = [&](const QList<Script> &scripts, const Script &script) {
-                for (auto&& scr : scripts)
-                    if (scr.filename == script.filename)
-                        return true;
-                return false;
-            };
+            // http header rule
+            case ProviderFormat::Key::HttpHeader:
+            {
+                const auto rule = HttpHeaderRule::parse(i.value.toString());
+                if (rule.isValid())
+                {
+                    provider.httpHeaders.append(rule);
+                    qDebug() << provider_file << "Added header rule:" << QString(rule);
+                }
+                else
+                {
+                    qDebug() << provider_file << "Warning: invalid header rule" << i.value.toString() << "skipped.";
+                }
+                break;
+            }
 
-            if (!contains_script(provider.scripts, script))
+            // blocked domain / block list file
+            case ProviderFormat::Key::Block:
             {
-                provider.scripts.append(script);
-                qDebug() << provider_file << "Loaded script" << script.filename << "with mode" << script.injectionPoint;
+                const auto domain = i.value.toString().trimmed();
+                if (!domain.isEmpty() && !provider.blockedDomains.contains(domain))
+                    provider.blockedDomains.append(domain);
+                break;
             }
-            else
+            case ProviderFormat::Key::BlockList:
             {
-                qDebug() << provider_file << "Warning: Duplicate 'script' skipped ->" << script;
+                const auto blockList = i.value.toString().trimmed();
+                if (!blockList.isEmpty() && !provider.blockLists.contains(blockList))
+                    provider.blockLists.append(blockList);
+                break;
             }
-        }
 
-        // http accept-language header
-        else if (i.startsWith("httpAcceptLanguage:", Qt::CaseInsensitive))
-        {
-            const auto header = i.mid(19).simplified();
-            provider.httpAcceptLanguage = header;
+            // unknown option
+            case ProviderFormat::Key::Unknown:
+                qDebug() << "Warning: unknown option" << i.line.toString() << "skipped.";
+                break;
         }
+    } // end while loop
 
-        // unknown option
-        else
-        {
-            qDebug() << "Warning: unknown option" << i.simplified() << "skipped.";
-        }
-    } // end for loop
+    if (mapped)
+        file.unmap(mapped);
+    file.close();
 
     if (provider.name.isEmpty())
     {
         qDebug() << provider_file << "Field 'name' must not be empty.";
         hasErrors = true;
     }
-    if (provider.icon.icon.isNull())
+    if (provider.icon.value.isEmpty())
     {
         qDebug() << provider_file << "Field 'icon' is empty. Falling back to text name.";
     }
@@ -225,7 +414,7 @@ StreamingProviderParser::StatusCode StreamingProviderParser::parse(const QString
     {
         for (auto&& url : provider.urlInterceptorLinks)
         {
-            if (url.pattern.isEmpty() || url.target.isEmpty())
+            if (!url.hasRule() || url.target.isEmpty())
             {
                 qDebug() << provider_file << "URL Interceptor list is invalid. Please fix the issue.";
                 hasErrors = true;
@@ -239,21 +428,31 @@ StreamingProviderParser::StatusCode StreamingProviderParser::parse(const QString
         return SYNTAX_ERROR;
     }
 
-    StreamingProviderStore::instance()->addProvider(provider);
+    (*provider_out) = provider;
 
     return SUCCESS;
 }
 
+QString StreamingProviderParser::iconFile(const QString &value, const QString &relativePathPrefix)
+{
+    if (QFileInfo(value).isAbsolute())
+        return value;
+    return relativePathPrefix + '/' + value;
+}
+
 void StreamingProviderParser::parseIcon(const QString &input, QString *value, QIcon *icon, const QString &relativePathPrefix)
 {
     if (!value || !icon)
         return;
 
     (*value) = input;
-    if (QFileInfo(input).isAbsolute())
-        (*icon) = QIcon(input);
-    else
-        (*icon) = QIcon(relativePathPrefix + '/' + input);
+
+    const auto file = StreamingProviderParser::iconFile(input, relativePathPrefix);
+    (*icon) = IconCache::icon(file, {ProviderIconLoader::buttonIconSize, ProviderIconLoader::titleBarIconSize}, qApp->devicePixelRatio());
+
+    // no image plugin for this file, let QIcon deal with it on demand
+    if (icon->isNull())
+        (*icon) = QIcon(file);
 }
 
 bool StreamingProviderParser::getBoolean(const QString &value)
@@ -306,9 +505,12 @@ void StreamingProviderParser::makeValidPaths()
 
 const QString StreamingProviderParser::findHighestPriorityProvider(const QString &provider_name) const
 {
-    QString provider;
-    for (auto&& path : this->m_providers)
-        if (path.endsWith(QFileInfo(provider_name).baseName() + StreamingProviderParser::extension))
-            provider = path;
-    return provider;
+    return this->m_highestPriority.value(StreamingProviderParser::baseName(provider_name));
+}
+
+QString StreamingProviderParser::baseName(const QString &provider_name)
+{
+    // same as QFileInfo::baseName() without the QFileInfo overhead
+    const auto fileName = provider_name.mid(provider_name.lastIndexOf('/') + 1);
+    return fileName.left(fileName.indexOf('.'));
 }
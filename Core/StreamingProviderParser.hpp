@@ -3,11 +3,13 @@
 
 #include <QString>
 #include <QStringList>
+#include <QHash>
 #include <QColor>
 
 #include "ConfigManager.hpp"
 
 class QIcon;
+struct Provider;
 
 class StreamingProviderParser
 {
@@ -26,17 +28,49 @@ public:
         ALREADY_IN_LIST
     };
 
+    struct ParseResult
+    {
+        QString file;
+        StatusCode status;
+    };
+
     void findAll();
+
+    // Find only the files of the given provider,
+    // for when a single provider is needed and parsing all is a waste.
+    void findProvider(const QString &provider_name);
+
     StatusCode parse(const QString &provider_name) const;
 
+    // Parse all found providers into the StreamingProviderStore.
+    // In parallel mode the files are parsed on the global thread pool
+    // and merged in priority order on the calling thread afterwards.
+    QList<ParseResult> parseAll(bool parallel = true) const;
+
+    // Parse a single provider file without touching the store.
+    // Thread-safe, the icon is not loaded (see ProviderIconLoader).
+    static StatusCode parseFile(const QString &provider_file, Provider *provider);
+
+    // provider id of the given file name or path
+    static QString baseName(const QString &provider_name);
+
     const QStringList &providers() const
     { return this->m_providers; }
 
+    // only the highest priority file of every provider, in discovery order
+    const QStringList &effectiveProviders() const
+    { return this->m_effectiveProviders; }
+
     static void parseIcon(const QString &input, QString *value, QIcon *icon,
                           const QString &relativePathPrefix = Config()->localProviderStoreDir());
 
+    // absolute path of an icon, relative paths are resolved against the provider directory
+    static QString iconFile(const QString &value, const QString &relativePathPrefix);
+
 private:
     QStringList m_providers;
+    QStringList m_effectiveProviders;
+    QHash<QString, QString> m_highestPriority; // provider id -> file
 
     static const char *extension;
     static const char *search_pattern;
@@ -44,6 +78,9 @@ private:
     static bool getBoolean(const QString &value);
     static QColor getColor(const QString &value, const QColor &fallback = QColor(0, 0, 0, 0));
 
+    // only files named exactly fileName when given, the name isn't used as a pattern
+    void find(const QString &pattern, const QString &fileName = QString());
+
     void makeValidPaths();
     QStringList m_validPaths;
 
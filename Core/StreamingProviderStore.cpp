@@ -1,39 +1,372 @@
 #include "StreamingProviderStore.hpp"
 #include "ConfigManager.hpp"
+#include "StreamingProviderParser.hpp"
+#include "ProviderFormat.hpp"
 
 #include <Widgets/BrowserWindow.hpp>
 
+static constexpr ProviderFormat::Keyword injectionPoints[] = {
+    {"deferred",         Script::Deferred},
+    {"deferr",           Script::Deferred},
+    {"defer",            Script::Deferred},
+    {"documentready",    Script::DocumentReady},
+    {"docready",         Script::DocumentReady},
+    {"ready",            Script::DocumentReady},
+    {"documentcreation", Script::DocumentCreation},
+    {"doccreation",      Script::DocumentCreation},
+    {"doccreate",        Script::DocumentCreation},
+    {"creation",         Script::DocumentCreation},
+    {"create",           Script::DocumentCreation},
+    {"automatic",        Script::Automatic},
+    {"auto",             Script::Automatic},
+};
+
 Script Script::parse(const QString &script)
 {
-    const auto scr = script.split(',', Qt::KeepEmptyParts);
-    if (scr.size() > 1)
-    {
-        const auto injection_pt = scr.at(1);
-        if (QString::compare(injection_pt, "deferred", Qt::CaseInsensitive) == 0 ||
-            QString::compare(injection_pt, "deferr", Qt::CaseInsensitive) == 0 ||
-            QString::compare(injection_pt, "defer", Qt::CaseInsensitive) == 0)
-            return Script{scr.at(0), Script::Deferred};
-        else if (QString::compare(injection_pt, "documentready", Qt::CaseInsensitive) == 0 ||
-                 QString::compare(injection_pt, "docready", Qt::CaseInsensitive) == 0 ||
-                 QString::compare(injection_pt, "ready", Qt::CaseInsensitive) == 0)
-            return Script{scr.at(0), Script::DocumentReady};
-        else if (QString::compare(injection_pt, "documentcreation", Qt::CaseInsensitive) == 0 ||
-                 QString::compare(injection_pt, "doccreation", Qt::CaseInsensitive) == 0 ||
-                 QString::compare(injection_pt, "doccreate", Qt::CaseInsensitive) == 0 ||
-                 QString::compare(injection_pt, "creation", Qt::CaseInsensitive) == 0 ||
-                 QString::compare(injection_pt, "create", Qt::CaseInsensitive) == 0)
-            return Script{scr.at(0), Script::DocumentCreation};
-        else if (QString::compare(injection_pt, "automatic", Qt::CaseInsensitive) == 0 ||
-                 QString::compare(injection_pt, "auto", Qt::CaseInsensitive) == 0 ||
-                 injection_pt.isEmpty())
-            return Script{scr.at(0), Script::Automatic};
+    // filename,injection_point[,ignored...]
+    const auto separator = script.indexOf(',');
+    if (separator == -1)
+        return Script{script, Script::Automatic};
+
+    const auto next = script.indexOf(',', separator + 1);
+    const auto injection_pt = script.midRef(separator + 1, next == -1 ? -1 : next - separator - 1);
+
+    return Script{script.left(separator), static_cast<Script::InjectionPoint>(
+        ProviderFormat::lookup(injectionPoints, injection_pt, Script::Automatic))};
+}
+
+UrlMatch UrlMatch::parse(const QString &match)
+{
+    UrlMatch urlMatch;
+
+    const auto scheme = match.indexOf(QLatin1String("://"));
+    if (scheme <= 0)
+        return urlMatch;
+
+    urlMatch.scheme = match.left(scheme).toLower();
+    if (urlMatch.scheme == "*")
+        urlMatch.scheme.clear();
+
+    const auto slash = match.indexOf('/', scheme + 3);
+    urlMatch.host = match.mid(scheme + 3, slash == -1 ? -1 : slash - scheme - 3).toLower();
+    if (urlMatch.host == "*")
+    {
+        urlMatch.host.clear();
+    }
+    else if (urlMatch.host.startsWith(QLatin1String("*.")))
+    {
+        urlMatch.host.remove(0, 2);
+        urlMatch.subdomains = true;
+    }
+    if (urlMatch.host.contains('*'))
+        return urlMatch;
+
+    // any path if omitted
+    if (slash != -1)
+    {
+        const auto path = match.mid(slash);
+        const auto wildcard = path.indexOf('*');
+        if (wildcard == -1)
+        {
+            urlMatch.pathPrefix = path;
+            urlMatch.pathWildcard = false;
+        }
         else
-            return Script{scr.at(0), Script::Automatic};
+        {
+            urlMatch.pathPrefix = path.left(wildcard);
+            urlMatch.pathSuffix = path.mid(wildcard + 1);
+            if (urlMatch.pathSuffix.contains('*'))
+                return urlMatch;
+        }
     }
+
+    urlMatch.valid = true;
+    return urlMatch;
+}
+
+UrlMatch::operator const QString() const
+{
+    if (!this->valid)
+        return QString();
+
+    QString ret = this->scheme.isEmpty() ? QString('*') : this->scheme;
+    ret.append("://");
+    if (this->host.isEmpty())
+        ret.append('*');
     else
+        ret.append((this->subdomains ? "*." : "") + this->host);
+    if (!this->pathWildcard)
+        ret.append(this->pathPrefix);
+    else if (!this->pathPrefix.isEmpty() || !this->pathSuffix.isEmpty())
+        ret.append(this->pathPrefix + '*' + this->pathSuffix);
+    return ret;
+}
+
+HttpHeaderRule HttpHeaderRule::parse(const QString &rule)
+{
+    HttpHeaderRule headerRule;
+
+    const auto separator = rule.indexOf(' ');
+    if (separator <= 0)
+        return headerRule;
+
+    auto host = rule.left(separator).toLower();
+    auto subdomains = false;
+    if (host == "*")
+    {
+        host.clear();
+    }
+    else if (host.startsWith(QLatin1String("*.")))
+    {
+        host.remove(0, 2);
+        subdomains = true;
+    }
+    if (host.contains('*'))
+        return headerRule;
+
+    //  > -Name
+    //  > Name: value
+    const auto header = rule.mid(separator + 1).trimmed();
+    QString name, value;
+    const auto clear = header.startsWith('-');
+    if (clear)
+    {
+        name = header.mid(1).trimmed();
+    }
+    else
+    {
+        const auto colon = header.indexOf(':');
+        if (colon == -1)
+            return headerRule;
+        name = header.left(colon).trimmed();
+        value = header.mid(colon + 1).trimmed();
+    }
+    if (name.contains(' ') || name.contains(':'))
+        return headerRule;
+    if (HttpHeaderRule::isReserved(name))
+    {
+        qDebug() << "Header" << name << "is set by the network stack and can't be changed by a rule.";
+        return headerRule;
+    }
+
+    headerRule.host = host;
+    headerRule.subdomains = subdomains;
+    headerRule.name = name;
+    headerRule.value = value;
+    headerRule.clear = clear;
+    return headerRule;
+}
+
+bool HttpHeaderRule::isReserved(const QString &name)
+{
+    // cookies are added after the interceptor ran, the others describe the connection
+    for (auto&& reserved : {"Cookie", "Host", "Content-Length"})
+        if (name.compare(QLatin1String(reserved), Qt::CaseInsensitive) == 0)
+            return true;
+    return false;
+}
+
+HttpHeaderRule::operator const QString() const
+{
+    if (!this->isValid())
+        return QString();
+
+    QString ret = this->host.isEmpty() ? QString('*') : (this->subdomains ? "*." : "") + this->host;
+    ret.append(' ');
+    if (this->clear)
+        ret.append('-' + this->name);
+    else
+        ret.append(this->name + ": " + this->value);
+    return ret;
+}
+
+bool UrlMatch::matches(const QUrl &url) const
+{
+    if (!this->valid)
+        return false;
+
+    if (!this->scheme.isEmpty() && url.scheme() != this->scheme)
+        return false;
+
+    if (!this->host.isEmpty())
+    {
+        const auto host = url.host();
+        if (this->subdomains)
+        {
+            // "*.domain" -> host must end with ".domain"
+            if (host.size() <= this->host.size() ||
+                host.at(host.size() - this->host.size() - 1) != '.' ||
+                !host.endsWith(this->host))
+                return false;
+        }
+        else if (host != this->host)
+        {
+            return false;
+        }
+    }
+
+    if (!this->pathWildcard)
+        return url.path() == this->pathPrefix;
+
+    if (this->pathPrefix.isEmpty() && this->pathSuffix.isEmpty())
+        return true;
+
+    const auto path = url.path();
+    return path.size() >= this->pathPrefix.size() + this->pathSuffix.size() &&
+           path.startsWith(this->pathPrefix) &&
+           path.endsWith(this->pathSuffix);
+}
+
+static constexpr ProviderFormat::Keyword resourceTypeNames[] = {
+    {"mainframe",                   QWebEngineUrlRequestInfo::ResourceTypeMainFrame},
+    {"subframe",                    QWebEngineUrlRequestInfo::ResourceTypeSubFrame},
+    {"stylesheet",                  QWebEngineUrlRequestInfo::ResourceTypeStylesheet},
+    {"script",                      QWebEngineUrlRequestInfo::ResourceTypeScript},
+    {"image",                       QWebEngineUrlRequestInfo::ResourceTypeImage},
+    {"font",                        QWebEngineUrlRequestInfo::ResourceTypeFontResource},
+    {"subresource",                 QWebEngineUrlRequestInfo::ResourceTypeSubResource},
+    {"object",                      QWebEngineUrlRequestInfo::ResourceTypeObject},
+    {"media",                       QWebEngineUrlRequestInfo::ResourceTypeMedia},
+    {"worker",                      QWebEngineUrlRequestInfo::ResourceTypeWorker},
+    {"sharedworker",                QWebEngineUrlRequestInfo::ResourceTypeSharedWorker},
+    {"prefetch",                    QWebEngineUrlRequestInfo::ResourceTypePrefetch},
+    {"favicon",                     QWebEngineUrlRequestInfo::ResourceTypeFavicon},
+    {"xhr",                         QWebEngineUrlRequestInfo::ResourceTypeXhr},
+    {"ping",                        QWebEngineUrlRequestInfo::ResourceTypePing},
+    {"serviceworker",               QWebEngineUrlRequestInfo::ResourceTypeServiceWorker},
+    {"csp",                         QWebEngineUrlRequestInfo::ResourceTypeCspReport},
+    {"plugin",                      QWebEngineUrlRequestInfo::ResourceTypePluginResource},
+    {"navigationpreloadmainframe",  QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadMainFrame},
+    {"navigationpreloadsubframe",   QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadSubFrame},
+    {"unknown",                     QWebEngineUrlRequestInfo::ResourceTypeUnknown},
+};
+
+bool UrlInterceptorLink::hasCaptureReferences(const QUrl &target)
+{
+    // backslashes are always percent-encoded, "\1" is "%5C1" here
+    const auto str = target.toString(QUrl::FullyEncoded);
+    for (auto pos = str.indexOf(QLatin1String("%5C"), 0, Qt::CaseInsensitive); pos != -1;
+         pos = str.indexOf(QLatin1String("%5C"), pos + 3, Qt::CaseInsensitive))
+    {
+        if (pos + 3 < str.size() && str.at(pos + 3).isDigit())
+            return true;
+    }
+    return false;
+}
+
+quint32 UrlInterceptorLink::parseResourceTypes(const QString &resourceTypes)
+{
+    quint32 mask = 0;
+    for (auto&& name : resourceTypes.splitRef(',', Qt::SkipEmptyParts))
     {
-        return Script{scr.at(0), Script::Automatic};
+        // shorthand for the main frame and sub frame navigation preloads
+        if (name.trimmed().compare(QLatin1String("navigationpreload"), Qt::CaseInsensitive) == 0)
+        {
+            mask |= UrlInterceptorLink::resourceTypeBit(QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadMainFrame) |
+                    UrlInterceptorLink::resourceTypeBit(QWebEngineUrlRequestInfo::ResourceTypeNavigationPreloadSubFrame);
+            continue;
+        }
+
+        const auto type = ProviderFormat::lookup(resourceTypeNames, name.trimmed(), -1);
+        if (type == -1)
+        {
+            qDebug() << "Warning: unknown resource type" << name.trimmed() << "skipped.";
+            continue;
+        }
+        mask |= UrlInterceptorLink::resourceTypeBit(type);
     }
+
+    // nothing valid given, don't disable the rule
+    return mask ? mask : AllResourceTypes;
+}
+
+QString UrlInterceptorLink::resourceTypesToString(quint32 resourceTypes)
+{
+    if (resourceTypes == AllResourceTypes)
+        return QString();
+
+    QStringList names;
+    for (auto&& type : resourceTypeNames)
+        if (resourceTypes & UrlInterceptorLink::resourceTypeBit(type.value))
+            names.append(QString::fromLatin1(type.name));
+    return names.join(',');
+}
+
+QDataStream &operator<< (QDataStream &stream, const Provider &provider)
+{
+    stream << provider.id << provider.path
+           << provider.name << provider.icon.value
+           << provider.url << provider.urlInterceptor << provider.useragent
+           << provider.titleBarPermanentTitle << provider.titleBarColor << provider.titleBarTextColor
+           << provider.titleBarVisible << provider.titleBarHasPermanentTitle;
+
+    stream << quint32(provider.urlInterceptorLinks.size());
+    for (auto&& link : provider.urlInterceptorLinks)
+        stream << link.pattern.pattern() << QString(link.match) << link.target << link.resourceTypes;
+
+    stream << quint32(provider.scripts.size());
+    for (auto&& script : provider.scripts)
+        stream << script.filename << qint32(script.injectionPoint);
+
+    stream << provider.httpAcceptLanguage;
+
+    stream << quint32(provider.httpHeaders.size());
+    for (auto&& rule : provider.httpHeaders)
+        stream << QString(rule);
+
+    stream << provider.blockedDomains << provider.blockLists << provider.isSystem;
+    return stream;
+}
+
+QDataStream &operator>> (QDataStream &stream, Provider &provider)
+{
+    QString icon;
+    stream >> provider.id >> provider.path
+           >> provider.name >> icon
+           >> provider.url >> provider.urlInterceptor >> provider.useragent
+           >> provider.titleBarPermanentTitle >> provider.titleBarColor >> provider.titleBarTextColor
+           >> provider.titleBarVisible >> provider.titleBarHasPermanentTitle;
+
+    quint32 count = 0;
+    stream >> count;
+    provider.urlInterceptorLinks.clear();
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString pattern, match;
+        QUrl target;
+        quint32 resourceTypes = UrlInterceptorLink::AllResourceTypes;
+        stream >> pattern >> match >> target >> resourceTypes;
+        provider.urlInterceptorLinks.append(UrlInterceptorLink{QRegExp(pattern), target, UrlMatch::parse(match), resourceTypes});
+    }
+
+    stream >> count;
+    provider.scripts.clear();
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString filename;
+        qint32 injectionPoint = Script::Automatic;
+        stream >> filename >> injectionPoint;
+        provider.scripts.append(Script{filename, static_cast<Script::InjectionPoint>(injectionPoint)});
+    }
+
+    stream >> provider.httpAcceptLanguage;
+
+    stream >> count;
+    provider.httpHeaders.clear();
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString rule;
+        stream >> rule;
+        provider.httpHeaders.append(HttpHeaderRule::parse(rule));
+    }
+
+    stream >> provider.blockedDomains >> provider.blockLists >> provider.isSystem;
+
+    // the icon is decoded later on (see ProviderIconLoader)
+    provider.icon.value = icon;
+    provider.icon.icon = QIcon();
+
+    return stream;
 }
 
 StreamingProviderStore *StreamingProviderStore::instance()
@@ -50,6 +383,7 @@ StreamingProviderStore::StreamingProviderStore()
 StreamingProviderStore::~StreamingProviderStore()
 {
     this->m_providers.clear();
+    this->m_index.clear();
     this->m_providerStorePaths.clear();
     delete this;
 }
@@ -67,30 +401,70 @@ const QStringList &StreamingProviderStore::providerStorePaths() const
 void StreamingProviderStore::addProvider(const Provider &provider)
 {
     if (!provider.id.isEmpty() && !this->contains(provider.id))
+    {
+        this->m_index.insert(provider.id, this->m_providers.size());
         this->m_providers.append(provider);
+    }
 }
 
-void StreamingProviderStore::removeProvider(const QString &id)
+void StreamingProviderStore::addProviders(const QList<Provider> &providers)
 {
-    for (auto i = 0; i < this->m_providers.size(); i++)
+    this->m_providers.reserve(this->m_providers.size() + providers.size());
+    this->m_index.reserve(this->m_providers.size() + providers.size());
+    for (auto&& provider : providers)
+        this->addProvider(provider);
+}
+
+void StreamingProviderStore::insertProvider(int index, const Provider &provider)
+{
+    if (provider.id.isEmpty() || this->contains(provider.id))
+        return;
+
+    if (index < 0 || index > this->m_providers.size())
+        index = this->m_providers.size();
+
+    this->m_providers.insert(index, provider);
+    this->reindex(index);
+}
+
+bool StreamingProviderStore::updateProvider(const QString &id, const Provider &provider)
+{
+    const auto it = this->m_index.constFind(id);
+    if (it == this->m_index.constEnd())
+        return false;
+
+    if (provider.id == id)
     {
-        if (this->m_providers.at(i).id == id)
-        {
-            this->m_providers.removeAt(i);
-            break;
-        }
+        this->m_providers[it.value()] = provider;
+        return true;
     }
+
+    // renamed: the id must be free, the provider moves to keep the list sorted
+    if (provider.id.isEmpty() || this->contains(provider.id))
+        return false;
+
+    this->removeProvider(id);
+    this->insertProvider(this->insertionIndex(provider.id), provider);
+    return true;
+}
+
+void StreamingProviderStore::removeProvider(const QString &id)
+{
+    const auto it = this->m_index.constFind(id);
+    if (it == this->m_index.constEnd())
+        return;
+
+    const auto pos = it.value();
+    this->m_index.erase(it);
+    this->m_providers.removeAt(pos);
+    this->reindex(pos);
 }
 
 const Provider &StreamingProviderStore::provider(const QString &id) const
 {
-    for (auto&& i : this->m_providers)
-    {
-        if (i.id == id)
-        {
-            return i;
-        }
-    }
+    const auto it = this->m_index.constFind(id);
+    if (it != this->m_index.constEnd())
+        return this->m_providers.at(it.value());
 
     // if the provider wasn't found return an empty one
     return this->m_null;
@@ -98,30 +472,38 @@ const Provider &StreamingProviderStore::provider(const QString &id) const
 
 Provider *StreamingProviderStore::provider_ptr(const QString &id)
 {
-    for (auto&& i : this->m_providers)
-    {
-        if (i.id == id)
-        {
-            return &i;
-        }
-    }
+    const auto it = this->m_index.constFind(id);
+    if (it != this->m_index.constEnd())
+        return &this->m_providers[it.value()];
 
     return nullptr;
 }
 
 Provider *StreamingProviderStore::providerAt_ptr(int index)
 {
-    if (index > this->m_providers.size())
+    if (index < 0 || index >= this->m_providers.size())
         return nullptr;
     return &this->m_providers[index];
 }
 
 bool StreamingProviderStore::contains(const QString &id) const
 {
-    for (auto&& provider : this->m_providers)
-        if (provider.id == id)
-            return true;
-    return false;
+    return this->m_index.contains(id);
+}
+
+int StreamingProviderStore::indexOf(const QString &id) const
+{
+    return this->m_index.value(id, -1);
+}
+
+int StreamingProviderStore::insertionIndex(const QString &id) const
+{
+    // position which keeps the list sorted by id, see sort()
+    const auto it = std::lower_bound(this->m_providers.cbegin(), this->m_providers.cend(), id,
+                                     [](const Provider &p, const QString &id){
+        return p.id < id;
+    });
+    return int(it - this->m_providers.cbegin());
 }
 
 void StreamingProviderStore::sort()
@@ -130,6 +512,13 @@ void StreamingProviderStore::sort()
               [](const Provider &p1, const Provider &p2){
         return p1.id < p2.id;
     });
+    this->reindex();
+}
+
+void StreamingProviderStore::reindex(int from)
+{
+    for (auto i = from; i < this->m_providers.size(); i++)
+        this->m_index.insert(this->m_providers.at(i).id, i);
 }
 
 void StreamingProviderStore::loadProfile(BrowserWindow *w, const Provider &pr)
@@ -151,7 +540,8 @@ void StreamingProviderStore::loadProfile(BrowserWindow *w, const Provider &pr)
     w->setWindowIcon(pr.icon.icon);
     w->setProfile(pr.id);
     w->setScripts(pr.scripts);
-    w->setUrlInterceptorEnabled(pr.urlInterceptor, pr.urlInterceptorLinks, pr.httpAcceptLanguage);
+    w->setUrlInterceptorEnabled(pr.urlInterceptor);
+    w->setRequestRules(pr);
     w->setUrl(pr.url);
 }
 
@@ -172,5 +562,6 @@ void StreamingProviderStore::resetProfile(BrowserWindow *w)
     w->setProfile("Default");
     w->removeScripts();
     w->setUrlInterceptorEnabled(def.urlInterceptor);
+    w->setRequestRules(def);
     w->setUrl(def.url);
 }
@@ -5,17 +5,67 @@
 #include <QStringList>
 #include <QUrl>
 #include <QList>
+#include <QVector>
+#include <QHash>
 #include <QColor>
 #include <QIcon>
+#include <QDataStream>
 
 #include <QWebEngineScript>
+#include <QWebEngineUrlRequestInfo>
 
 class BrowserWindow;
 
+// Non-regex url interceptor rule, matched on the QUrl components
+//  > scheme://host/path
+//     scheme: exact or *
+//     host:   exact, *.domain (any subdomain) or *
+//     path:   exact, prefix*, *suffix or prefix*suffix, any path if omitted (query is ignored)
+struct UrlMatch
+{
+    QString scheme;        // empty = any
+    QString host;          // empty = any
+    bool subdomains = false;
+    QString pathPrefix;
+    QString pathSuffix;
+    bool pathWildcard = true;
+    bool valid = false;
+
+    inline bool isValid() const { return this->valid; }
+    bool matches(const QUrl &url) const;
+
+    // convert helper
+    operator const QString() const;
+
+    // parse string and convert to UrlMatch struct
+    static UrlMatch parse(const QString &match);
+};
+
 struct UrlInterceptorLink
 {
     QRegExp pattern;
     QUrl target;
+    UrlMatch match; // used instead of the pattern when valid
+
+    // resource types the rule applies to, one bit per QWebEngineUrlRequestInfo::ResourceType
+    quint32 resourceTypes = AllResourceTypes;
+
+    inline bool hasRule() const
+    { return !this->pattern.isEmpty() || this->match.isValid(); }
+
+    static const quint32 AllResourceTypes = 0xffffffff;
+
+    // true if the target refers to capture groups (\0 to \9), only pattern rules capture anything
+    static bool hasCaptureReferences(const QUrl &target);
+
+    // bit of a QWebEngineUrlRequestInfo::ResourceType, unknown types share the last bit
+    static inline quint32 resourceTypeBit(int resourceType)
+    { return 1u << ((resourceType >= 0 && resourceType < 31) ? resourceType : 31); }
+
+    // convert helpers
+    //  > script,stylesheet,xhr
+    static quint32 parseResourceTypes(const QString &resourceTypes);
+    static QString resourceTypesToString(quint32 resourceTypes);
 };
 
 struct Script
@@ -46,6 +96,32 @@ struct Script
     static Script parse(const QString &script);
 };
 
+// Request header rule, applied to all requests to matching hosts
+//  > host Name: value   (set the header)
+//  > host -Name         (clear the header, it's sent with an empty value)
+//     host: exact, *.domain (any subdomain) or *
+// Headers the network stack sets itself (Cookie, Host, Content-Length) are rejected,
+// a rule would only send them empty or be overridden.
+struct HttpHeaderRule
+{
+    QString host;          // empty = any
+    bool subdomains = false;
+    QString name;
+    QString value;
+    bool clear = false;
+
+    inline bool isValid() const { return !this->name.isEmpty(); }
+
+    // convert helper
+    operator const QString() const;
+
+    // parse string and convert to HttpHeaderRule struct
+    static HttpHeaderRule parse(const QString &rule);
+
+    // true if the header is owned by the network stack
+    static bool isReserved(const QString &name);
+};
+
 #include <QDebug>
 inline QDebug operator<< (QDebug d, const Script::InjectionPoint &injection_pt)
 {
@@ -93,10 +169,20 @@ struct Provider
     QList<Script> scripts;
 
     QString    httpAcceptLanguage;
+    QList<HttpHeaderRule> httpHeaders;
+
+    // blocked domains (subdomains included) and block list files
+    QStringList blockedDomains;
+    QStringList blockLists;
 
     bool isSystem;
 };
 
+// binary (de)serialization of a parsed provider
+//  > the icon is stored by value and reloaded on deserialization
+QDataStream &operator<< (QDataStream &stream, const Provider &provider);
+QDataStream &operator>> (QDataStream &stream, Provider &provider);
+
 class StreamingProviderStore
 {
 public:
@@ -107,8 +193,11 @@ public:
     const QStringList &providerStorePaths() const;
 
     void addProvider(const Provider &provider);
+    void addProviders(const QList<Provider> &providers);
+    void insertProvider(int index, const Provider &provider);
+    bool updateProvider(const QString &id, const Provider &provider); // false if not found or the new id is taken
     void removeProvider(const QString &id);
-    const QList<Provider> &providers() const
+    const QVector<Provider> &providers() const
     { return this->m_providers; }
     const Provider &providerAt(int index) const
     { return this->m_providers.at(index); }
@@ -117,6 +206,8 @@ public:
     Provider *providerAt_ptr(int index);
 
     bool contains(const QString &id) const;
+    int indexOf(const QString &id) const;
+    int insertionIndex(const QString &id) const;
     inline int count() const { return this->m_providers.size(); }
     void sort();
 
@@ -125,9 +216,12 @@ public:
 
 private:
     StreamingProviderStore();
-    QList<Provider> m_providers;
+    QVector<Provider> m_providers;
+    QHash<QString, int> m_index; // id -> position in m_providers
     QStringList m_providerStorePaths;
 
+    void reindex(int from = 0);
+
     Provider m_null;
 };
 
@@ -0,0 +1,182 @@
+#include "StreamingProviderWatcher.hpp"
+#include "StreamingProviderParser.hpp"
+#include "ProviderIconLoader.hpp"
+#include "ConfigManager.hpp"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
+
+#include <QDebug>
+
+StreamingProviderWatcher *StreamingProviderWatcher::instance()
+{
+    static StreamingProviderWatcher *i = new StreamingProviderWatcher();
+    return i;
+}
+
+StreamingProviderWatcher::StreamingProviderWatcher()
+{
+    // coalesce bursts of file system events (editors, rsync, etc.)
+    this->m_rescanTimer.setSingleShot(true);
+    this->m_rescanTimer.setInterval(250);
+    QObject::connect(&this->m_rescanTimer, &QTimer::timeout, this, &StreamingProviderWatcher::rescan);
+
+    QObject::connect(&this->m_watcher, &QFileSystemWatcher::directoryChanged, &this->m_rescanTimer, QOverload<>::of(&QTimer::start));
+    QObject::connect(&this->m_watcher, &QFileSystemWatcher::fileChanged, &this->m_rescanTimer, QOverload<>::of(&QTimer::start));
+}
+
+StreamingProviderWatcher::~StreamingProviderWatcher()
+{
+    this->m_files.clear();
+}
+
+void StreamingProviderWatcher::start()
+{
+    QStringList watchPaths;
+    this->m_files = this->scan(&watchPaths);
+
+    if (!watchPaths.isEmpty())
+        this->m_watcher.addPaths(watchPaths);
+
+    qDebug() << "Watching" << this->m_watcher.directories() << "for provider changes.";
+}
+
+void StreamingProviderWatcher::addProvider(const Provider &provider)
+{
+    if (provider.id.isEmpty())
+        return;
+
+    if (StreamingProviderStore::instance()->contains(provider.id))
+    {
+        this->updateProvider(provider.id, provider);
+        return;
+    }
+
+    const auto index = StreamingProviderStore::instance()->insertionIndex(provider.id);
+    emit providerAboutToBeAdded(index);
+    StreamingProviderStore::instance()->insertProvider(index, provider);
+    emit providerAdded(provider.id, index);
+}
+
+bool StreamingProviderWatcher::updateProvider(const QString &id, const Provider &provider)
+{
+    const auto index = StreamingProviderStore::instance()->indexOf(id);
+    if (index == -1)
+        return false;
+
+    if (provider.id != id)
+    {
+        if (provider.id.isEmpty() || StreamingProviderStore::instance()->contains(provider.id))
+        {
+            qDebug() << "Unable to rename" << id << "to" << provider.id << "- the id is already taken.";
+            return false;
+        }
+
+        this->removeProvider(id);
+        this->addProvider(provider);
+        return true;
+    }
+
+    StreamingProviderStore::instance()->updateProvider(id, provider);
+    emit providerChanged(provider.id, index);
+    return true;
+}
+
+void StreamingProviderWatcher::removeProvider(const QString &id)
+{
+    const auto index = StreamingProviderStore::instance()->indexOf(id);
+    if (index == -1)
+        return;
+
+    emit providerAboutToBeRemoved(index);
+    StreamingProviderStore::instance()->removeProvider(id);
+    emit providerRemoved(id, index);
+}
+
+QHash<QString, StreamingProviderWatcher::FileStamp> StreamingProviderWatcher::scan(QStringList *watchPaths) const
+{
+    StreamingProviderParser parser;
+    parser.findAll();
+
+    QHash<QString, FileStamp> files;
+    QSet<QString> directories;
+
+    for (auto&& path : Config()->providerStoreDirs())
+        if (QFileInfo(path).isDir())
+            directories.insert(path);
+
+    for (auto&& file : parser.providers())
+        directories.insert(QFileInfo(file).path());
+
+    for (auto&& file : parser.effectiveProviders())
+    {
+        const QFileInfo info(file);
+        files.insert(StreamingProviderParser::baseName(file),
+                     FileStamp{file, info.lastModified().toMSecsSinceEpoch(), info.size()});
+    }
+
+    if (watchPaths)
+    {
+        (*watchPaths) = QStringList(directories.values());
+        watchPaths->append(parser.providers());
+    }
+
+    return files;
+}
+
+void StreamingProviderWatcher::rescan()
+{
+    QStringList watchPaths;
+    const auto files = this->scan(&watchPaths);
+
+    // removed providers
+    for (auto it = this->m_files.cbegin(); it != this->m_files.cend(); ++it)
+    {
+        if (!files.contains(it.key()))
+        {
+            qDebug() << it.value().file << "was removed.";
+            this->removeProvider(it.key());
+        }
+    }
+
+    // new and changed providers, only those files are parsed again
+    for (auto it = files.cbegin(); it != files.cend(); ++it)
+    {
+        const auto previous = this->m_files.constFind(it.key());
+        if (previous != this->m_files.cend() &&
+            previous.value().file == it.value().file &&
+            previous.value().mtime == it.value().mtime &&
+            previous.value().size == it.value().size)
+            continue;
+
+        Provider provider;
+        const auto status = StreamingProviderParser::parseFile(it.value().file, &provider);
+        if (status == StreamingProviderParser::SUCCESS)
+        {
+            qDebug() << it.value().file << "was reloaded.";
+
+            // keep showing the current icon until the new one is decoded
+            const auto current = StreamingProviderStore::instance()->provider_ptr(provider.id);
+            if (current && current->icon.value == provider.icon.value && current->path == provider.path)
+                provider.icon.icon = current->icon.icon;
+
+            this->addProvider(provider);
+            ProviderIconLoader::instance()->load(provider);
+        }
+        else
+        {
+            qDebug() << it.value().file << "has issues and was unloaded!";
+            this->removeProvider(it.key());
+        }
+    }
+
+    this->m_files = files;
+
+    // files may have been replaced (new inode), so renew all watches
+    const auto watched = this->m_watcher.files() + this->m_watcher.directories();
+    if (!watched.isEmpty())
+        this->m_watcher.removePaths(watched);
+    if (!watchPaths.isEmpty())
+        this->m_watcher.addPaths(watchPaths);
+}
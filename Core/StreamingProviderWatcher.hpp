@@ -0,0 +1,58 @@
+#ifndef STREAMINGPROVIDERWATCHER_HPP
+#define STREAMINGPROVIDERWATCHER_HPP
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QHash>
+
+#include "StreamingProviderStore.hpp"
+
+// Keeps the StreamingProviderStore in sync with the provider files on disk
+// and notifies listeners about every single change made to the store.
+class StreamingProviderWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StreamingProviderWatcher *instance();
+    ~StreamingProviderWatcher();
+
+    // start watching the provider store directories
+    void start();
+
+    // apply a change to the store and notify listeners
+    void addProvider(const Provider &provider);
+    // a renamed provider is removed and added at its new position,
+    // returns false if the provider wasn't found or the new id is already taken
+    bool updateProvider(const QString &id, const Provider &provider);
+    void removeProvider(const QString &id);
+
+signals:
+    void providerAboutToBeAdded(int index);
+    void providerAdded(const QString &id, int index);
+    void providerChanged(const QString &id, int index);
+    void providerAboutToBeRemoved(int index);
+    void providerRemoved(const QString &id, int index);
+
+private slots:
+    void rescan();
+
+private:
+    StreamingProviderWatcher();
+
+    struct FileStamp
+    {
+        QString file;
+        qint64 mtime;
+        qint64 size;
+    };
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_rescanTimer;
+    QHash<QString, FileStamp> m_files; // provider id -> highest priority file
+
+    QHash<QString, FileStamp> scan(QStringList *watchPaths) const;
+};
+
+#endif // STREAMINGPROVIDERWATCHER_HPP
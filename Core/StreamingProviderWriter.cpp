@@ -1,10 +1,14 @@
 #include "StreamingProviderWriter.hpp"
 #include "StreamingProviderParser.hpp"
+#include "ProviderFormat.hpp"
 
 #include "ConfigManager.hpp"
 
 #include <QFile>
 #include <QFileInfo>
+#include <QVector>
+
+#include <algorithm>
 
 StreamingProviderWriter::StatusCode StreamingProviderWriter::write(const Provider &provider)
 {
@@ -52,23 +56,49 @@ StreamingProviderWriter::StatusCode StreamingProviderWriter::write_private(
             /// append them in the last step (alters position in file)
             ///
 
+            // classify every line once
+            QVector<ProviderFormat::Key> keys;
+            keys.reserve(props.size());
+            for (auto&& prop : props)
+                keys.append(ProviderFormat::key(prop));
+
             // find all positions of stackable options
-            static const auto find_pos_of_all = [&](const QString &startsWith)
+            const auto find_pos_of_all = [&](ProviderFormat::Key key)
             {
                 QList<int> pos;
-                for (auto i = 0; i < props.size(); i++)
-                    if (props.at(i).startsWith(startsWith, Qt::CaseInsensitive))
+                for (auto i = 0; i < keys.size(); i++)
+                    if (keys.at(i) == key)
                         pos.append(i);
                 return pos;
             };
 
             // find all url interceptor and script options
-            auto patternPositions = find_pos_of_all("urlInterceptorPattern:");
-            auto targetPositions = find_pos_of_all("urlInterceptorTarget:");
-            auto scriptPositions = find_pos_of_all("script:");
+            // patterns and matches are both rules, in order of appearance
+            auto patternPositions = find_pos_of_all(ProviderFormat::Key::UrlInterceptorPattern) +
+                                    find_pos_of_all(ProviderFormat::Key::UrlInterceptorMatch);
+            std::sort(patternPositions.begin(), patternPositions.end());
+            auto targetPositions = find_pos_of_all(ProviderFormat::Key::UrlInterceptorTarget);
+            auto scriptPositions = find_pos_of_all(ProviderFormat::Key::Script);
+
+            // resource type restrictions belong to the preceding rule
+            const auto resourceTypePositions = find_pos_of_all(ProviderFormat::Key::UrlInterceptorResourceTypes);
+            QVector<int> resourceTypeLines(patternPositions.size(), -1);
+            for (auto&& i : resourceTypePositions)
+            {
+                const auto rule = int(std::upper_bound(patternPositions.begin(), patternPositions.end(), i) - patternPositions.begin()) - 1;
+                if (rule >= 0)
+                    resourceTypeLines[rule] = i;
+            }
+
+            // a rule got restricted, lines can't be inserted in place
+            bool resourceTypesAdded = false;
+            for (auto i = 0; i < patternPositions.size() && i < provider.urlInterceptorLinks.size(); i++)
+                if (provider.urlInterceptorLinks.at(i).resourceTypes != UrlInterceptorLink::AllResourceTypes &&
+                    resourceTypeLines.at(i) == -1)
+                    resourceTypesAdded = true;
 
             bool urlInterceptorsRemoved = false;
-            if (patternPositions.size() != provider.urlInterceptorLinks.size())
+            if (patternPositions.size() != provider.urlInterceptorLinks.size() || resourceTypesAdded)
             {
                 urlInterceptorsRemoved = true;
 
@@ -77,6 +107,8 @@ StreamingProviderWriter::StatusCode StreamingProviderWriter::write_private(
                     props[i].clear();
                 for (auto&& i : targetPositions)
                     props[i].clear();
+                for (auto&& i : resourceTypePositions)
+                    props[i].clear();
 
                 // avoid updating
                 patternPositions.clear();
@@ -99,35 +131,54 @@ StreamingProviderWriter::StatusCode StreamingProviderWriter::write_private(
             ///
             /// edit existing properties
             ///
-            for (auto&& prop : props)
+            for (auto i = 0; i < props.size(); i++)
             {
-                if (prop.startsWith("name:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.name);
-                else if (prop.startsWith("icon:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.icon.value);
-                else if (prop.startsWith("url:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.url.toString());
-                else if (prop.startsWith("urlInterceptor:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.urlInterceptor ? "true" : "false");
-                else if (prop.startsWith("user-agent:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.useragent);
-                else if (prop.startsWith("titlebar:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.titleBarVisible ? "true" : "false");
-                else if (provider.titleBarHasPermanentTitle &&
-                         prop.startsWith("titlebar-text:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.titleBarPermanentTitle);
-                else if (prop.startsWith("titlebar-color:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.titleBarColor.name(QColor::HexRgb));
-                else if (prop.startsWith("titlebar-text-color:", Qt::CaseInsensitive))
-                    replace_value(prop, provider.titleBarTextColor.name(QColor::HexRgb));
+                auto &prop = props[i];
+                switch (keys.at(i))
+                {
+                    case ProviderFormat::Key::Name:
+                        replace_value(prop, provider.name); break;
+                    case ProviderFormat::Key::Icon:
+                        replace_value(prop, provider.icon.value); break;
+                    case ProviderFormat::Key::Url:
+                        replace_value(prop, provider.url.toString()); break;
+                    case ProviderFormat::Key::UrlInterceptor:
+                        replace_value(prop, provider.urlInterceptor ? "true" : "false"); break;
+                    case ProviderFormat::Key::UserAgent:
+                        replace_value(prop, provider.useragent); break;
+                    case ProviderFormat::Key::TitleBar:
+                        replace_value(prop, provider.titleBarVisible ? "true" : "false"); break;
+                    case ProviderFormat::Key::TitleBarText:
+                        if (provider.titleBarHasPermanentTitle)
+                            replace_value(prop, provider.titleBarPermanentTitle);
+                        break;
+                    case ProviderFormat::Key::TitleBarColor:
+                        replace_value(prop, provider.titleBarColor.name(QColor::HexRgb)); break;
+                    case ProviderFormat::Key::TitleBarTextColor:
+                        replace_value(prop, provider.titleBarTextColor.name(QColor::HexRgb)); break;
+                    default:
+                        break;
+                }
             }
 
             // update url interceptors
             int internalCounter_Interceptors = 0;
             for (auto i = 0; i < patternPositions.size(); i++)
             {
-                replace_value(props[patternPositions.at(i)], provider.urlInterceptorLinks.at(internalCounter_Interceptors).pattern.pattern());
+                const auto &link = provider.urlInterceptorLinks.at(internalCounter_Interceptors);
+                auto &prop = props[patternPositions.at(i)];
+                if (keys.at(patternPositions.at(i)) == interceptor_rule_key(link))
+                    replace_value(prop, interceptor_rule_value(link));
+                else
+                    prop = interceptor_rule(link);
                 replace_value(props[targetPositions.at(i)], provider.urlInterceptorLinks.at(internalCounter_Interceptors).target.toString());
+                if (resourceTypeLines.at(i) != -1)
+                {
+                    if (link.resourceTypes == UrlInterceptorLink::AllResourceTypes)
+                        props[resourceTypeLines.at(i)].clear();
+                    else
+                        replace_value(props[resourceTypeLines.at(i)], UrlInterceptorLink::resourceTypesToString(link.resourceTypes));
+                }
                 internalCounter_Interceptors++;
             }
 
@@ -142,38 +193,37 @@ StreamingProviderWriter::StatusCode StreamingProviderWriter::write_private(
             ///
             /// add new properties
             ///
-            static const auto contains_option = [&](const QString &option)
+            const auto contains_option = [&](ProviderFormat::Key key)
             {
-                for (auto&& prop : props)
-                    if (prop.startsWith(option, Qt::CaseInsensitive))
-                        return true;
-                return false;
+                return keys.contains(key);
             };
 
-            if (!contains_option("name:"))
+            if (!contains_option(ProviderFormat::Key::Name))
                 props.append("name:" + provider.name);
-            if (!contains_option("icon:"))
+            if (!contains_option(ProviderFormat::Key::Icon))
                 props.append("icon:" + provider.icon.value);
-            if (!contains_option("url:"))
+            if (!contains_option(ProviderFormat::Key::Url))
                 props.append("url:" + provider.url.toString());
-            if (provider.urlInterceptor && !contains_option("urlInterceptor:"))
+            if (provider.urlInterceptor && !contains_option(ProviderFormat::Key::UrlInterceptor))
                 props.append("urlInterceptor:true");
             for (auto i = internalCounter_Interceptors; i < provider.urlInterceptorLinks.size(); i++)
             {
-                props.append("urlInterceptorPattern:" + provider.urlInterceptorLinks.at(i).pattern.pattern());
+                props.append(interceptor_rule(provider.urlInterceptorLinks.at(i)));
                 props.append("urlInterceptorTarget:" + provider.urlInterceptorLinks.at(i).target.toString());
+                if (provider.urlInterceptorLinks.at(i).resourceTypes != UrlInterceptorLink::AllResourceTypes)
+                    props.append("urlInterceptorResourceTypes:" + UrlInterceptorLink::resourceTypesToString(provider.urlInterceptorLinks.at(i).resourceTypes));
             }
             for (auto i = internalCounter_Scripts; i < provider.scripts.size(); i++)
                 props.append("script:" + provider.scripts.at(i));
-            if (!contains_option("user-agent:") && !provider.useragent.isEmpty())
+            if (!contains_option(ProviderFormat::Key::UserAgent) && !provider.useragent.isEmpty())
                 props.append("user-agent:" + provider.useragent);
-            if (!contains_option("titlebar:") && provider.titleBarVisible)
+            if (!contains_option(ProviderFormat::Key::TitleBar) && provider.titleBarVisible)
                 props.append("titlebar:true");
-            if (!contains_option("titlebar-text:") && provider.titleBarHasPermanentTitle)
+            if (!contains_option(ProviderFormat::Key::TitleBarText) && provider.titleBarHasPermanentTitle)
                 props.append("titlebar-text:" + provider.titleBarPermanentTitle);
-            if (!contains_option("titlebar-color:") && provider.titleBarVisible)
+            if (!contains_option(ProviderFormat::Key::TitleBarColor) && provider.titleBarVisible)
                 props.append("titlebar-color:" + provider.titleBarColor.name(QColor::HexRgb));
-            if (!contains_option("titlebar-text-color:") && provider.titleBarVisible)
+            if (!contains_option(ProviderFormat::Key::TitleBarTextColor) && provider.titleBarVisible)
                 props.append("titlebar-text-color:" + provider.titleBarTextColor.name(QColor::HexRgb));
 
 
@@ -208,11 +258,19 @@ StreamingProviderWriter::StatusCode StreamingProviderWriter::write_private(
                 s << "urlInterceptor:true" << '\n';
             for (auto&& interceptor : provider.urlInterceptorLinks)
             {
-                s << "urlInterceptorPattern:" << interceptor.pattern.pattern() << '\n';
+                s << interceptor_rule(interceptor) << '\n';
                 s << "urlInterceptorTarget:" << interceptor.target.toString() << '\n';
+                if (interceptor.resourceTypes != UrlInterceptorLink::AllResourceTypes)
+                    s << "urlInterceptorResourceTypes:" << UrlInterceptorLink::resourceTypesToString(interceptor.resourceTypes) << '\n';
             }
             for (auto&& script : provider.scripts)
                 s << "script:" << script << '\n';
+            for (auto&& rule : provider.httpHeaders)
+                s << "httpHeader:" << QString(rule) << '\n';
+            for (auto&& domain : provider.blockedDomains)
+                s << "block:" << domain << '\n';
+            for (auto&& blockList : provider.blockLists)
+                s << "blockList:" << blockList << '\n';
             if (!provider.useragent.isEmpty())
                 s << "user-agent:" << provider.useragent << '\n';
             if (provider.titleBarVisible)
@@ -236,6 +294,23 @@ StreamingProviderWriter::StatusCode StreamingProviderWriter::write_private(
     }
 }
 
+ProviderFormat::Key StreamingProviderWriter::interceptor_rule_key(const UrlInterceptorLink &link)
+{
+    return link.match.isValid() ?
+        ProviderFormat::Key::UrlInterceptorMatch :
+        ProviderFormat::Key::UrlInterceptorPattern;
+}
+
+QString StreamingProviderWriter::interceptor_rule_value(const UrlInterceptorLink &link)
+{
+    return link.match.isValid() ? QString(link.match) : link.pattern.pattern();
+}
+
+QString StreamingProviderWriter::interceptor_rule(const UrlInterceptorLink &link)
+{
+    return QString::fromLatin1(ProviderFormat::name(interceptor_rule_key(link))) + ':' + interceptor_rule_value(link);
+}
+
 void StreamingProviderWriter::replace_value(QString &in, const QString &new_value)
 {
     auto key_sep = in.indexOf(':');
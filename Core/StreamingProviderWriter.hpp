@@ -2,6 +2,7 @@
 #define STREAMINGPROVIDERWRITER_HPP
 
 #include "StreamingProviderStore.hpp"
+#include "ProviderFormat.hpp"
 
 #include <QString>
 #include <QStringList>
@@ -24,6 +25,11 @@ public:
 private:
     static StatusCode write_private(const Provider &provider, const QString &file, bool preserveCommentsAndLinefeeds);
     static void replace_value(QString &in, const QString &new_value);
+
+    // urlInterceptorPattern or urlInterceptorMatch line of the given rule
+    static ProviderFormat::Key interceptor_rule_key(const UrlInterceptorLink &link);
+    static QString interceptor_rule_value(const UrlInterceptorLink &link);
+    static QString interceptor_rule(const UrlInterceptorLink &link);
 };
 
 #endif // STREAMINGPROVIDERWRITER_HPP
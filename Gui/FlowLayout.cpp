@@ -76,6 +76,15 @@ void FlowLayout::addItem(QLayoutItem *item)
     itemList.append(item);
 }
 
+void FlowLayout::insertWidget(int index, QWidget *widget)
+{
+    addChildWidget(widget);
+    if (index < 0 || index > itemList.size())
+        index = itemList.size();
+    itemList.insert(index, new QWidgetItem(widget));
+    invalidate();
+}
+
 int FlowLayout::horizontalSpacing() const
 {
     if (m_hSpace >= 0) {
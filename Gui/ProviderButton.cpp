@@ -1,9 +1,10 @@
 #include "ProviderButton.hpp"
 
+#include <Core/StreamingProviderWatcher.hpp>
+
 QPushButton *ProviderButton::create(const Provider &provider)
 {
-    QPushButton *btn = new QPushButton(provider.name);
-    btn->setObjectName(provider.id);
+    QPushButton *btn = new QPushButton();
     btn->setGeometry(-1, -1, 80, 80);
     btn->setFixedWidth(95);
     btn->setFixedHeight(95);
@@ -16,6 +17,18 @@ QPushButton *ProviderButton::create(const Provider &provider)
         "QPushButton:hover{outline: none; border: 1px solid #ffffff; padding: 5px; background-color: #555555;}"
         "QPushButton:pressed{outline: none; border: 1px solid #ffffff; padding: 5px; background-color: #484848;}");
 
+    ProviderButton::update(btn, provider);
+
+    return btn;
+}
+
+void ProviderButton::update(QPushButton *btn, const Provider &provider)
+{
+    if (!btn)
+        return;
+
+    btn->setObjectName(provider.id);
+
     if (!provider.icon.icon.isNull())
     {
         btn->setIcon(provider.icon.icon);
@@ -23,13 +36,34 @@ QPushButton *ProviderButton::create(const Provider &provider)
         btn->setText(QString());
         btn->setToolTip(provider.name);
     }
-
-    return btn;
+    else
+    {
+        btn->setIcon(QIcon());
+        btn->setText(provider.name);
+        btn->setToolTip(QString());
+    }
 }
 
 ProviderListModel::ProviderListModel(QObject *parent)
     : QAbstractTableModel(parent)
 {
+    // follow single provider changes instead of resetting the whole model
+    const auto watcher = StreamingProviderWatcher::instance();
+    QObject::connect(watcher, &StreamingProviderWatcher::providerAboutToBeAdded, this, [&](int index){
+        this->beginInsertRows(QModelIndex(), index, index);
+    });
+    QObject::connect(watcher, &StreamingProviderWatcher::providerAdded, this, [&]{
+        this->endInsertRows();
+    });
+    QObject::connect(watcher, &StreamingProviderWatcher::providerAboutToBeRemoved, this, [&](int index){
+        this->beginRemoveRows(QModelIndex(), index, index);
+    });
+    QObject::connect(watcher, &StreamingProviderWatcher::providerRemoved, this, [&]{
+        this->endRemoveRows();
+    });
+    QObject::connect(watcher, &StreamingProviderWatcher::providerChanged, this, [&](const QString &, int index){
+        emit this->dataChanged(this->index(index, 0), this->index(index, this->columnCount() - 1));
+    });
 }
 
 ProviderListModel::~ProviderListModel()
@@ -9,6 +9,7 @@
 namespace ProviderButton
 {
     QPushButton *create(const Provider &provider);
+    void update(QPushButton *btn, const Provider &provider);
 };
 
 class ProviderListModel : public QAbstractTableModel
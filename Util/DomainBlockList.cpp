@@ -0,0 +1,253 @@
+#include "DomainBlockList.hpp"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QRegularExpression>
+
+#include <QDebug>
+
+const int DomainBlockList::bloomHashes = 4;
+const quint64 DomainBlockList::hashSeed = Q_UINT64_C(14695981039346656037);
+
+DomainBlockList::DomainBlockList()
+{
+    this->m_terminal.append(false); // root
+}
+
+void DomainBlockList::add(const QString &domain)
+{
+    auto str = domain.trimmed().toLower();
+    if (str.startsWith(QLatin1String("*.")))
+        str.remove(0, 2);
+    while (str.startsWith('.'))
+        str.remove(0, 1);
+    while (str.endsWith('.'))
+        str.chop(1);
+
+    if (str.isEmpty() || str.contains('/') || str.contains(' ') || str.contains(QLatin1String("..")))
+        return;
+
+    auto node = 0;
+    auto end = str.size();
+    while (end > 0)
+    {
+        // a parent domain is blocked already
+        if (this->m_terminal.at(node))
+            return;
+
+        const auto start = str.lastIndexOf('.', end - 1) + 1;
+        const auto edge = qMakePair(node, str.mid(start, end - start));
+        const auto it = this->m_edges.constFind(edge);
+        if (it != this->m_edges.cend())
+        {
+            node = it.value();
+        }
+        else
+        {
+            this->m_terminal.append(false);
+            node = this->m_terminal.size() - 1;
+            this->m_edges.insert(edge, node);
+        }
+        end = start - 1;
+    }
+
+    if (this->m_terminal.at(node))
+        return;
+
+    // subdomains of this domain stay in the trie, but are never reached anymore
+    this->m_terminal[node] = true;
+    this->m_count++;
+
+    // outdated until compile() is called again
+    this->m_bloom.clear();
+}
+
+bool DomainBlockList::addFile(const QString &file)
+{
+    QFile in(file);
+    if (!in.open(QFile::ReadOnly | QFile::Text))
+    {
+        qDebug() << "Unable to read block list" << file;
+        return false;
+    }
+
+    static const QRegularExpression whitespace("\\s+");
+    static const QRegularExpression separators("[\\^$|]");
+
+    // names of the machine itself in hosts files
+    static const QStringList localNames{
+        "localhost", "localhost.localdomain", "local", "broadcasthost",
+        "ip6-localhost", "ip6-loopback", "ip6-localnet", "ip6-mcastprefix",
+        "ip6-allnodes", "ip6-allrouters", "ip6-allhosts",
+    };
+
+    QTextStream stream(&in);
+    QString line;
+    while (stream.readLineInto(&line))
+    {
+        line = line.trimmed();
+
+        // adblock comments, list headers ("[Adblock Plus 2.0]"), exceptions and element hiding rules
+        if (line.startsWith('!') || line.startsWith('[') || line.startsWith(QLatin1String("@@")) ||
+            line.contains(QLatin1String("##")) || line.contains(QLatin1String("#@#")) || line.contains(QLatin1String("#?#")))
+            continue;
+
+        const auto comment = line.indexOf('#');
+        if (comment != -1)
+            line.truncate(comment);
+
+        const auto fields = line.split(whitespace, Qt::SkipEmptyParts);
+        if (fields.isEmpty())
+            continue;
+
+        // hosts file, every name after the address
+        //  > 0.0.0.0 a.example b.example
+        if (fields.size() > 1)
+        {
+            for (auto i = 1; i < fields.size(); i++)
+                if (!localNames.contains(fields.at(i), Qt::CaseInsensitive))
+                    this->add(fields.at(i));
+            continue;
+        }
+
+        // adblock style domain rule, options and separators are dropped
+        //  > ||domain^
+        //  > ||domain^$third-party
+        auto domain = fields.first();
+        if (domain.startsWith(QLatin1String("||")))
+        {
+            domain.remove(0, 2);
+            const auto separator = domain.indexOf(separators);
+            if (separator != -1)
+                domain.truncate(separator);
+        }
+
+        // other adblock rules aren't domains, add() skips the ones with paths
+        if (domain.contains('$') || domain.indexOf('*', domain.startsWith(QLatin1String("*.")) ? 2 : 0) != -1 ||
+            localNames.contains(domain, Qt::CaseInsensitive))
+            continue;
+
+        this->add(domain);
+    }
+
+    return true;
+}
+
+void DomainBlockList::compile()
+{
+    // ~10 bits per domain, about 1% false positives with 4 hashes
+    quint32 bits = 64;
+    while (bits < quint32(this->m_count) * 10 && bits < (1u << 31))
+        bits <<= 1;
+
+    this->m_bloom.fill(0, int(bits / 64));
+    this->m_bloomMask = bits - 1;
+
+    // walk the trie and hash every blocked domain
+    QVector<QString> labels(this->m_terminal.size());
+    QVector<int> parents(this->m_terminal.size(), -1);
+    for (auto it = this->m_edges.cbegin(); it != this->m_edges.cend(); ++it)
+    {
+        labels[it.value()] = it.key().second;
+        parents[it.value()] = it.key().first;
+    }
+
+    QVector<int> path;
+    for (auto i = 1; i < this->m_terminal.size(); i++)
+    {
+        if (!this->m_terminal.at(i))
+            continue;
+
+        path.clear();
+        for (auto node = i; node > 0; node = parents.at(node))
+            path.append(node);
+
+        // same order as mayContain(), characters from right to left
+        auto hash = DomainBlockList::hashSeed;
+        for (auto p = path.size() - 1; p >= 0; p--)
+        {
+            const auto &label = labels.at(path.at(p));
+            for (auto c = label.size() - 1; c >= 0; c--)
+                hash = DomainBlockList::hashStep(hash, label.at(c));
+            if (p > 0)
+                hash = DomainBlockList::hashStep(hash, QChar('.'));
+        }
+
+        this->insertBloom(hash);
+    }
+}
+
+bool DomainBlockList::contains(const QString &host) const
+{
+    if (this->m_count == 0 || host.isEmpty())
+        return false;
+
+    if (!this->m_bloom.isEmpty() && !this->mayContain(host))
+        return false;
+
+    auto node = 0;
+    auto end = host.size();
+    if (host.endsWith('.'))
+        end--;
+    while (end > 0)
+    {
+        // label without copying the host
+        const auto start = host.lastIndexOf('.', end - 1) + 1;
+        const auto label = QString::fromRawData(host.constData() + start, end - start);
+
+        const auto it = this->m_edges.constFind(qMakePair(node, label));
+        if (it == this->m_edges.cend())
+            return false;
+
+        node = it.value();
+        if (this->m_terminal.at(node))
+            return true;
+
+        end = start - 1;
+    }
+
+    return false;
+}
+
+bool DomainBlockList::mayContain(const QString &host) const
+{
+    auto hash = DomainBlockList::hashSeed;
+    auto i = host.size() - 1;
+    if (i >= 0 && host.at(i) == '.')
+        i--;
+
+    // every suffix starting at a label boundary, in a single pass
+    for (; i >= 0; i--)
+    {
+        hash = DomainBlockList::hashStep(hash, host.at(i));
+        if ((i == 0 || host.at(i - 1) == '.') && this->testBloom(hash))
+            return true;
+    }
+
+    return false;
+}
+
+void DomainBlockList::insertBloom(quint64 hash)
+{
+    const auto h1 = quint32(hash);
+    const auto h2 = quint32(hash >> 32) | 1;
+    for (auto k = 0; k < DomainBlockList::bloomHashes; k++)
+    {
+        const auto bit = (h1 + quint32(k) * h2) & this->m_bloomMask;
+        this->m_bloom[int(bit >> 6)] |= Q_UINT64_C(1) << (bit & 63);
+    }
+}
+
+bool DomainBlockList::testBloom(quint64 hash) const
+{
+    const auto h1 = quint32(hash);
+    const auto h2 = quint32(hash >> 32) | 1;
+    for (auto k = 0; k < DomainBlockList::bloomHashes; k++)
+    {
+        const auto bit = (h1 + quint32(k) * h2) & this->m_bloomMask;
+        if (!(this->m_bloom.at(int(bit >> 6)) & (Q_UINT64_C(1) << (bit & 63))))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef DOMAINBLOCKLIST_HPP
+#define DOMAINBLOCKLIST_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QUrl>
+
+// Set of blocked domains, a domain blocks all of its subdomains too.
+//
+// Domains are stored in a trie of their labels in reverse order (com -> example -> ads),
+// a host is looked up label by label from the right, so the cost only depends on
+// the length of the host and not on the number of entries.
+// A bloom filter over the domains rejects almost all hosts which aren't blocked
+// before the trie is touched, the hashes are computed incrementally over all
+// suffixes of the host in a single pass.
+class DomainBlockList
+{
+public:
+    DomainBlockList();
+
+    // add a domain, leading "*." and "." are ignored
+    void add(const QString &domain);
+
+    // add all domains of a block list file, returns false if the file can't be read
+    //  > one domain per line, # starts a comment
+    //  > hosts file format: "0.0.0.0 domain [domain...]" and "127.0.0.1 domain [domain...]"
+    //  > adblock domain rules: "||domain^" and "||domain^$options", ! starts a comment
+    bool addFile(const QString &file);
+
+    // build the bloom filter, must be called after adding domains
+    void compile();
+
+    // true if the host or one of its parent domains is blocked
+    bool contains(const QString &host) const;
+    inline bool blocks(const QUrl &url) const
+    { return this->m_count != 0 && this->contains(url.host()); }
+
+    inline int count() const
+    { return this->m_count; }
+    inline bool isEmpty() const
+    { return this->m_count == 0; }
+
+private:
+    // trie, node 0 is the root
+    QVector<bool> m_terminal;
+    QHash<QPair<int, QString>, int> m_edges; // (parent, label) -> child
+    int m_count = 0;
+
+    // bloom filter
+    QVector<quint64> m_bloom;
+    quint32 m_bloomMask = 0;
+    static const int bloomHashes;
+
+    bool mayContain(const QString &host) const;
+    void insertBloom(quint64 hash);
+    bool testBloom(quint64 hash) const;
+
+    // FNV-1a over the characters from right to left
+    static inline quint64 hashStep(quint64 hash, QChar c)
+    { return (hash ^ c.unicode()) * Q_UINT64_C(1099511628211); }
+    static const quint64 hashSeed;
+};
+
+#endif // DOMAINBLOCKLIST_HPP
@@ -0,0 +1,85 @@
+#include "LatencyHistogram.hpp"
+
+#include <QJsonArray>
+
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (auto&& bucket : this->m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::record(quint64 nsecs)
+{
+    this->m_buckets[LatencyHistogram::bucket(nsecs)].fetch_add(1, std::memory_order_relaxed);
+    this->m_count.fetch_add(1, std::memory_order_relaxed);
+    this->m_total.fetch_add(nsecs, std::memory_order_relaxed);
+
+    auto max = this->m_max.load(std::memory_order_relaxed);
+    while (nsecs > max && !this->m_max.compare_exchange_weak(max, nsecs, std::memory_order_relaxed))
+        ;
+}
+
+quint64 LatencyHistogram::percentile(double percentile) const
+{
+    const auto count = this->count();
+    if (count == 0)
+        return 0;
+
+    const auto rank = qMax<quint64>(1, quint64(std::ceil(double(count) * qBound(0.0, percentile, 100.0) / 100.0)));
+    quint64 seen = 0;
+    for (auto i = 0; i < LatencyHistogram::bucketCount; i++)
+    {
+        seen += this->m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return qMin(LatencyHistogram::upperBound(i), this->max());
+    }
+
+    return this->max();
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    QJsonArray buckets;
+    for (auto i = 0; i < LatencyHistogram::bucketCount; i++)
+    {
+        const auto count = this->m_buckets[i].load(std::memory_order_relaxed);
+        if (count != 0)
+            buckets.append(QJsonArray{qint64(LatencyHistogram::upperBound(i)), qint64(count)});
+    }
+
+    return QJsonObject{
+        {"count", qint64(this->count())},
+        {"totalNsecs", qint64(this->total())},
+        {"maxNsecs", qint64(this->max())},
+        {"p50", qint64(this->percentile(50))},
+        {"p90", qint64(this->percentile(90))},
+        {"p99", qint64(this->percentile(99))},
+        {"p999", qint64(this->percentile(99.9))},
+        {"buckets", buckets},
+    };
+}
+
+int LatencyHistogram::bucket(quint64 nsecs)
+{
+    // exact below the first power of two range
+    if (nsecs < quint64(LatencyHistogram::subBuckets))
+        return int(nsecs);
+
+    //  > magnitude: position of the highest bit above the sub-bucket bits
+    //  > sub-bucket: the following bits
+    const auto magnitude = (63 - qCountLeadingZeroBits(nsecs)) - LatencyHistogram::subBucketBits;
+    const auto subBucket = int(nsecs >> magnitude) - LatencyHistogram::subBuckets;
+    return qMin((magnitude + 1) * LatencyHistogram::subBuckets + subBucket, LatencyHistogram::bucketCount - 1);
+}
+
+quint64 LatencyHistogram::upperBound(int bucket)
+{
+    if (bucket < LatencyHistogram::subBuckets)
+        return quint64(bucket);
+
+    const auto magnitude = bucket / LatencyHistogram::subBuckets - 1;
+    const auto subBucket = bucket % LatencyHistogram::subBuckets;
+    return ((quint64(LatencyHistogram::subBuckets + subBucket) << magnitude) + (Q_UINT64_C(1) << magnitude)) - 1;
+}
@@ -0,0 +1,49 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <QtGlobal>
+#include <QJsonObject>
+
+#include <array>
+#include <atomic>
+
+// Lock-free log-linear (HDR style) histogram of durations in nanoseconds.
+//
+// Every power of two range is split into 16 linear sub-buckets, a recorded value
+// is off by at most 1/16 of its magnitude (~6%), from 1 ns up to several hours.
+// record() only does relaxed atomic increments and can be called from any thread.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(quint64 nsecs);
+
+    inline quint64 count() const { return this->m_count.load(std::memory_order_relaxed); }
+    inline quint64 total() const { return this->m_total.load(std::memory_order_relaxed); }
+    inline quint64 max() const { return this->m_max.load(std::memory_order_relaxed); }
+
+    // upper bound of the bucket containing the percentile (0-100), 0 if empty
+    quint64 percentile(double percentile) const;
+
+    //  > {"count": n, "totalNsecs": n, "maxNsecs": n, "p50": n, "p90": n, "p99": n, "p999": n,
+    //     "buckets": [[upper bound, count], ...]}
+    // only non-empty buckets are listed
+    QJsonObject toJson() const;
+
+private:
+    static const int subBucketBits = 4;
+    static const int subBuckets = 1 << subBucketBits;
+    static const int magnitudes = 40;
+    static const int bucketCount = (magnitudes + 1) * subBuckets;
+
+    static int bucket(quint64 nsecs);
+    static quint64 upperBound(int bucket);
+
+    std::array<std::atomic<quint64>, bucketCount> m_buckets;
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_total{0};
+    std::atomic<quint64> m_max{0};
+};
+
+#endif // LATENCYHISTOGRAM_HPP
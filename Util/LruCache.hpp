@@ -0,0 +1,69 @@
+#ifndef LRUCACHE_HPP
+#define LRUCACHE_HPP
+
+#include <QHash>
+
+#include <list>
+#include <utility>
+
+// Bounded key-value cache, evicts the least recently used entry.
+// Not thread-safe, callers must lock.
+template<typename Key, typename Value>
+class LruCache
+{
+public:
+    explicit LruCache(int capacity)
+        : m_capacity(capacity > 0 ? capacity : 1)
+    {}
+
+    // returns true and moves the entry to the front if found
+    bool find(const Key &key, Value *value)
+    {
+        const auto it = this->m_index.constFind(key);
+        if (it == this->m_index.cend())
+            return false;
+
+        this->m_entries.splice(this->m_entries.begin(), this->m_entries, it.value());
+        if (value)
+            (*value) = it.value()->second;
+        return true;
+    }
+
+    void insert(const Key &key, const Value &value)
+    {
+        const auto it = this->m_index.constFind(key);
+        if (it != this->m_index.cend())
+        {
+            it.value()->second = value;
+            this->m_entries.splice(this->m_entries.begin(), this->m_entries, it.value());
+            return;
+        }
+
+        if (this->m_index.size() >= this->m_capacity)
+        {
+            this->m_index.remove(this->m_entries.back().first);
+            this->m_entries.pop_back();
+        }
+
+        this->m_entries.emplace_front(key, value);
+        this->m_index.insert(key, this->m_entries.begin());
+    }
+
+    void clear()
+    {
+        this->m_entries.clear();
+        this->m_index.clear();
+    }
+
+    inline int size() const { return this->m_index.size(); }
+    inline int capacity() const { return this->m_capacity; }
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    int m_capacity;
+    Entries m_entries; // most recently used first
+    QHash<Key, typename Entries::iterator> m_index;
+};
+
+#endif // LRUCACHE_HPP
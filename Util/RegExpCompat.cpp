@@ -0,0 +1,118 @@
+#include "RegExpCompat.hpp"
+
+namespace RegExpCompat
+{
+
+static inline bool isHexDigit(QChar c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+QString translate(const QRegExp &regexp)
+{
+    if (!regexp.isValid())
+        return QString();
+
+    switch (regexp.patternSyntax())
+    {
+        case QRegExp::RegExp:
+        case QRegExp::RegExp2:
+            break;
+        case QRegExp::FixedString:
+            return QRegularExpression::escape(regexp.pattern());
+        default:
+            // wildcard semantics differ, keep QRegExp for those
+            return QString();
+    }
+
+    const auto &pattern = regexp.pattern();
+
+    QString translated;
+    translated.reserve(pattern.size() + 8);
+
+    for (auto i = 0; i < pattern.size(); i++)
+    {
+        const auto c = pattern.at(i);
+        if (c != '\\' || i + 1 >= pattern.size())
+        {
+            translated.append(c);
+            continue;
+        }
+
+        const auto escaped = pattern.at(++i);
+
+        //  > \xhhhh  -> \x{hhhh}
+        if (escaped == 'x')
+        {
+            QString hex;
+            while (hex.size() < 4 && i + 1 < pattern.size() && isHexDigit(pattern.at(i + 1)))
+                hex.append(pattern.at(++i));
+            if (hex.isEmpty())
+                return QString();
+            translated.append("\\x{" + hex + '}');
+        }
+
+        //  > \0ooo  -> \x{hhhh}
+        else if (escaped == '0')
+        {
+            auto value = 0, digits = 0;
+            while (digits < 3 && i + 1 < pattern.size() && pattern.at(i + 1) >= '0' && pattern.at(i + 1) <= '7')
+            {
+                value = value * 8 + (pattern.at(++i).unicode() - '0');
+                digits++;
+            }
+            translated.append("\\x{" + QString::number(value, 16) + '}');
+        }
+
+        // identical in both engines
+        else
+        {
+            translated.append(c);
+            translated.append(escaped);
+        }
+    }
+
+    return translated;
+}
+
+QRegularExpression::PatternOptions options(const QRegExp &regexp)
+{
+    // QRegExp: '.' matches newlines and \w, \s, \d are unicode aware
+    QRegularExpression::PatternOptions options =
+        QRegularExpression::DotMatchesEverythingOption |
+        QRegularExpression::UseUnicodePropertiesOption;
+
+    if (regexp.caseSensitivity() == Qt::CaseInsensitive)
+        options |= QRegularExpression::CaseInsensitiveOption;
+    if (regexp.isMinimal())
+        options |= QRegularExpression::InvertedGreedinessOption;
+
+    return options;
+}
+
+bool exactMatch(const QRegExp &regexp, QRegularExpression *expression)
+{
+    const auto translated = RegExpCompat::translate(regexp);
+    if (translated.isNull())
+        return false;
+
+    return RegExpCompat::exactMatch(translated, RegExpCompat::options(regexp), expression);
+}
+
+bool exactMatch(const QString &translated, QRegularExpression::PatternOptions options, QRegularExpression *expression)
+{
+    if (!expression)
+        return false;
+
+    // the whole string must match, \z doesn't match before a trailing newline like $ does
+    const QRegularExpression compiled("\\A(?:" + translated + ")\\z", options);
+    if (!compiled.isValid())
+        return false;
+
+    // compile and JIT now, not on the first request
+    compiled.optimize();
+    (*expression) = compiled;
+    return true;
+}
+
+}
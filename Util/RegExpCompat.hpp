@@ -0,0 +1,29 @@
+#ifndef REGEXPCOMPAT_HPP
+#define REGEXPCOMPAT_HPP
+
+#include <QString>
+#include <QRegExp>
+#include <QRegularExpression>
+
+// Translation of QRegExp patterns to QRegularExpression (PCRE2, JIT compiled).
+// The pattern text itself stays in QRegExp syntax, this is only used for matching.
+namespace RegExpCompat
+{
+
+// Translate the pattern of a QRegExp to PCRE syntax, not anchored.
+// Returns a null string for constructs which can't be translated.
+QString translate(const QRegExp &regexp);
+
+// Matching options equivalent to the options of the QRegExp
+QRegularExpression::PatternOptions options(const QRegExp &regexp);
+
+// Compile an optimized expression with the semantics of QRegExp::exactMatch().
+// Returns false if the pattern can't be translated.
+bool exactMatch(const QRegExp &regexp, QRegularExpression *expression);
+
+// Anchor a translated pattern for exact matching and compile it.
+bool exactMatch(const QString &translated, QRegularExpression::PatternOptions options, QRegularExpression *expression);
+
+}
+
+#endif // REGEXPCOMPAT_HPP
@@ -0,0 +1,106 @@
+#include "RequestTrace.hpp"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QDir>
+
+#include <QDebug>
+
+const quint32 RequestTrace::newUrl = 0xffffffff;
+
+const char *RequestTrace::header = "Lrequest_trace";
+const quint32 RequestTrace::version = 1;
+
+RequestTrace::RequestTrace(const QString &file)
+    : m_file(file)
+{
+    if (!this->m_file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qDebug() << "[Request Trace] Unable to write" << file;
+        return;
+    }
+
+    this->m_stream.setDevice(&this->m_file);
+    this->m_stream.setVersion(QDataStream::Qt_5_9);
+    this->m_stream << QByteArray(RequestTrace::header) << RequestTrace::version;
+
+    qDebug() << "[Request Trace] Recording requests to" << file;
+}
+
+RequestTrace::~RequestTrace()
+{
+    if (!this->isOpen())
+        return;
+
+    this->m_file.close();
+    qDebug() << "[Request Trace]" << this->m_count << "requests," << this->m_urls.size() << "distinct urls recorded to" << this->m_file.fileName();
+}
+
+void RequestTrace::record(const QUrl &url, int resourceType)
+{
+    if (!this->isOpen())
+        return;
+
+    const auto encoded = url.toEncoded();
+    const auto it = this->m_urls.constFind(encoded);
+    if (it != this->m_urls.cend())
+    {
+        this->m_stream << quint8(resourceType) << it.value();
+    }
+    else
+    {
+        this->m_stream << quint8(resourceType) << RequestTrace::newUrl << encoded;
+        this->m_urls.insert(encoded, quint32(this->m_urls.size()));
+    }
+
+    this->m_count++;
+}
+
+QString RequestTrace::processFile(const QString &file, const QString &providerId)
+{
+    const QFileInfo info(file);
+    const auto suffix = info.completeSuffix();
+    return QDir(info.path()).filePath(info.baseName() + '-' + providerId + '-' +
+                                      QString::number(QCoreApplication::applicationPid()) +
+                                      (suffix.isEmpty() ? QString() : '.' + suffix));
+}
+
+bool RequestTrace::load(const QString &file, QVector<Request> *requests)
+{
+    QFile trace(file);
+    if (!trace.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream stream(&trace);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    QByteArray magic;
+    quint32 traceVersion = 0;
+    stream >> magic >> traceVersion;
+    if (stream.status() != QDataStream::Ok || magic != RequestTrace::header || traceVersion != RequestTrace::version)
+        return false;
+
+    QVector<QUrl> urls;
+    while (!stream.atEnd())
+    {
+        quint8 resourceType = 0;
+        quint32 reference = 0;
+        stream >> resourceType >> reference;
+
+        if (reference == RequestTrace::newUrl)
+        {
+            QByteArray encoded;
+            stream >> encoded;
+            urls.append(QUrl::fromEncoded(encoded));
+            reference = quint32(urls.size() - 1);
+        }
+
+        // a recording which was cut off keeps all complete requests
+        if (stream.status() != QDataStream::Ok || reference >= quint32(urls.size()))
+            break;
+
+        requests->append(Request{urls.at(int(reference)), int(resourceType)});
+    }
+
+    return true;
+}
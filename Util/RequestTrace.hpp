@@ -0,0 +1,60 @@
+#ifndef REQUESTTRACE_HPP
+#define REQUESTTRACE_HPP
+
+#include <QString>
+#include <QByteArray>
+#include <QUrl>
+#include <QVector>
+#include <QHash>
+#include <QFile>
+#include <QDataStream>
+
+// Binary trace of the requests seen by the URL interceptor, replayed by the
+// InterceptorReplay benchmark to measure rule changes with reproducible input.
+//
+//  > header, version
+//  > per request: resource type (quint8), url reference (quint32)
+//                 followed by the encoded url when the url wasn't seen before
+//
+// Streaming players request the same urls over and over again,
+// every distinct url is only stored once.
+class RequestTrace
+{
+public:
+    struct Request
+    {
+        QUrl url;
+        int resourceType; // QWebEngineUrlRequestInfo::ResourceType
+    };
+
+    // start recording to the file, an existing file is replaced
+    explicit RequestTrace(const QString &file);
+    ~RequestTrace();
+
+    inline bool isOpen() const
+    { return this->m_file.isOpen(); }
+    inline quint32 count() const
+    { return this->m_count; }
+
+    void record(const QUrl &url, int resourceType);
+
+    // trace file of a browser window spawned by the main interface, each process gets its own file
+    //  > trace.bin -> trace-{provider}-{pid}.bin
+    static QString processFile(const QString &file, const QString &providerId);
+
+    // read all requests of a trace, returns false if the file isn't a valid trace
+    static bool load(const QString &file, QVector<Request> *requests);
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+    QHash<QByteArray, quint32> m_urls; // encoded url -> reference
+    quint32 m_count = 0;
+
+    static const quint32 newUrl;
+
+    static const char *header;
+    static const quint32 version;
+};
+
+#endif // REQUESTTRACE_HPP
@@ -0,0 +1,230 @@
+#include "TargetCache.hpp"
+
+#include <Core/ConfigManager.hpp>
+
+#include <QWebEngineUrlScheme>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QMimeDatabase>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QDataStream>
+#include <QBuffer>
+
+#include <QDebug>
+
+const QByteArray TargetCache::scheme = QByteArrayLiteral("cache");
+
+const char *TargetCache::header = "Ltarget_cache";
+const quint32 TargetCache::version = 1;
+
+TargetCache *TargetCache::instance()
+{
+    static TargetCache *i = new TargetCache();
+    return i;
+}
+
+TargetCache::TargetCache()
+{
+}
+
+TargetCache::~TargetCache()
+{
+    this->m_pending.clear();
+}
+
+void TargetCache::registerScheme()
+{
+    QWebEngineUrlScheme cacheScheme(TargetCache::scheme);
+    cacheScheme.setSyntax(QWebEngineUrlScheme::Syntax::Path);
+
+    // targets replace resources of https pages (player scripts, etc.)
+    cacheScheme.setFlags(QWebEngineUrlScheme::SecureScheme |
+                         QWebEngineUrlScheme::CorsEnabled |
+                         QWebEngineUrlScheme::ContentSecurityPolicyIgnored);
+    QWebEngineUrlScheme::registerScheme(cacheScheme);
+}
+
+void TargetCache::requestStarted(QWebEngineUrlRequestJob *job)
+{
+    Target target;
+    if (!TargetCache::parse(job->requestUrl(), &target))
+    {
+        qDebug() << "[Target Cache] Invalid url" << job->requestUrl();
+        job->fail(QWebEngineUrlRequestJob::UrlInvalid);
+        return;
+    }
+
+    const auto key = TargetCache::cacheKey(target);
+    const auto cached = this->m_entries.constFind(key);
+    if (cached != this->m_entries.cend())
+    {
+        TargetCache::reply(job, cached.value());
+        return;
+    }
+
+    // verified once per session, afterwards served from memory
+    Entry entry;
+    if (TargetCache::load(TargetCache::cacheFile(target), &entry) && TargetCache::verify(target, entry.content))
+    {
+        this->m_entries.insert(key, entry);
+        TargetCache::reply(job, entry);
+        return;
+    }
+
+    // a download for this target is already running
+    auto &pending = this->m_pending[key];
+    pending.append(job);
+    if (pending.size() == 1)
+        this->download(key, target);
+}
+
+void TargetCache::refresh()
+{
+    QDir dir(Config()->targetCacheDir());
+    for (auto&& file : dir.entryList({"*.bin"}, QDir::Files))
+        dir.remove(file);
+    this->m_entries.clear();
+
+    qDebug() << "[Target Cache] Cleared, targets are downloaded again on the next request.";
+}
+
+bool TargetCache::parse(const QUrl &url, Target *target)
+{
+    // everything after "cache:", the query belongs to the origin
+    auto str = url.toString(QUrl::RemoveScheme | QUrl::RemoveFragment | QUrl::FullyEncoded);
+
+    //  > sha256-{hex}:{origin}
+    if (str.startsWith(QLatin1String("sha256-")))
+    {
+        const auto separator = str.indexOf(':');
+        if (separator == -1)
+            return false;
+        target->sha256 = str.mid(7, separator - 7).toLatin1().toLower();
+        str = str.mid(separator + 1);
+
+        if (target->sha256.size() != 64)
+            return false;
+    }
+
+    target->origin = QUrl(str, QUrl::StrictMode);
+    return target->origin.isValid() &&
+           (target->origin.scheme() == QLatin1String("https") || target->origin.scheme() == QLatin1String("http"));
+}
+
+bool TargetCache::verify(const Target &target, const QByteArray &content)
+{
+    return target.sha256.isEmpty() ||
+           QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex() == target.sha256;
+}
+
+QString TargetCache::cacheKey(const Target &target)
+{
+    //  > [{sha256}:]{origin}
+    const auto origin = target.origin.toString(QUrl::FullyEncoded);
+    return target.sha256.isEmpty() ? origin : QString::fromLatin1(target.sha256) + ':' + origin;
+}
+
+QString TargetCache::cacheFile(const Target &target)
+{
+    //  > {sha1 of the cache key}.bin
+    return Config()->targetCacheDir() + '/' +
+           QString::fromLatin1(QCryptographicHash::hash(TargetCache::cacheKey(target).toUtf8(), QCryptographicHash::Sha1).toHex()) + ".bin";
+}
+
+bool TargetCache::load(const QString &cacheFile, Entry *entry)
+{
+    QFile cache(cacheFile);
+    if (!cache.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    QByteArray magic;
+    quint32 cacheVersion = 0;
+    stream >> magic >> cacheVersion >> entry->mimeType >> entry->content;
+
+    return stream.status() == QDataStream::Ok &&
+           magic == TargetCache::header && cacheVersion == TargetCache::version;
+}
+
+bool TargetCache::save(const QString &cacheFile, const Entry &entry)
+{
+    if (!QDir().mkpath(Config()->targetCacheDir()))
+        return false;
+
+    QSaveFile cache(cacheFile);
+    if (!cache.open(QFile::WriteOnly))
+        return false;
+
+    QDataStream stream(&cache);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << QByteArray(TargetCache::header) << TargetCache::version << entry.mimeType << entry.content;
+
+    if (stream.status() != QDataStream::Ok || !cache.commit())
+    {
+        qDebug() << "[Target Cache] Error writing" << cacheFile;
+        return false;
+    }
+
+    return true;
+}
+
+void TargetCache::download(const QString &key, const Target &target)
+{
+    qDebug() << "[Target Cache] Downloading" << target.origin;
+
+    QNetworkRequest request(target.origin);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+
+    const auto networkReply = this->m_network.get(request);
+    QObject::connect(networkReply, &QNetworkReply::finished, this, [=]{
+        networkReply->deleteLater();
+        const auto jobs = this->m_pending.take(key);
+
+        Entry entry;
+        entry.content = networkReply->readAll();
+
+        if (networkReply->error() != QNetworkReply::NoError)
+        {
+            qDebug() << "[Target Cache] Download of" << target.origin << "failed:" << networkReply->errorString();
+            for (auto&& job : jobs)
+                if (job)
+                    job->fail(QWebEngineUrlRequestJob::RequestFailed);
+            return;
+        }
+
+        if (!TargetCache::verify(target, entry.content))
+        {
+            qDebug() << "[Target Cache] Integrity check of" << target.origin << "failed, not serving it!";
+            for (auto&& job : jobs)
+                if (job)
+                    job->fail(QWebEngineUrlRequestJob::RequestDenied);
+            return;
+        }
+
+        // strip parameters like the charset, fall back to the file name and content
+        entry.mimeType = networkReply->header(QNetworkRequest::ContentTypeHeader).toByteArray().split(';').first().trimmed();
+        if (entry.mimeType.isEmpty())
+            entry.mimeType = QMimeDatabase().mimeTypeForFileNameAndData(target.origin.path(), entry.content).name().toLatin1();
+
+        TargetCache::save(TargetCache::cacheFile(target), entry);
+        this->m_entries.insert(key, entry);
+
+        for (auto&& job : jobs)
+            if (job)
+                TargetCache::reply(job, entry);
+    });
+}
+
+void TargetCache::reply(QWebEngineUrlRequestJob *job, const Entry &entry)
+{
+    // the device must stay alive as long as the job exists
+    auto buffer = new QBuffer();
+    buffer->setData(entry.content);
+    QObject::connect(job, &QObject::destroyed, buffer, &QObject::deleteLater);
+    job->reply(entry.mimeType, buffer);
+}
@@ -0,0 +1,83 @@
+#ifndef TARGETCACHE_HPP
+#define TARGETCACHE_HPP
+
+#include <QWebEngineUrlSchemeHandler>
+#include <QWebEngineUrlRequestJob>
+#include <QNetworkAccessManager>
+
+#include <QString>
+#include <QByteArray>
+#include <QUrl>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+
+// Serves URL interceptor targets from a local content cache through the "cache:" scheme.
+//
+//  > urlInterceptorTarget:cache:https://cdn.example.com/player.js
+//  > urlInterceptorTarget:cache:sha256-{hex}:https://cdn.example.com/player.js
+//
+// The origin is downloaded on the first request and stored in the TargetCache
+// subfolder of the configuration directory, later requests are served from disk.
+// With an integrity hash the download and the cached copy are verified,
+// content which doesn't match is never served. Verified content is kept in memory,
+// later requests in the same session neither read nor hash the file again.
+class TargetCache : public QWebEngineUrlSchemeHandler
+{
+    Q_OBJECT
+
+public:
+    static TargetCache *instance();
+    ~TargetCache() override;
+
+    static const QByteArray scheme;
+
+    // register the scheme with Qt Web Engine, must be called before the QApplication is created
+    static void registerScheme();
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override;
+
+    // drop all cached copies, targets are downloaded again on the next request
+    void refresh();
+
+private:
+    TargetCache();
+
+    struct Target
+    {
+        QUrl origin;
+        QByteArray sha256; // hex, empty if not given
+    };
+
+    struct Entry
+    {
+        QByteArray mimeType;
+        QByteArray content;
+    };
+
+    static bool parse(const QUrl &url, Target *target);
+    static bool verify(const Target &target, const QByteArray &content);
+
+    // the pinned hash is part of the key, targets pinning different
+    // versions of the same origin don't replace each other
+    static QString cacheKey(const Target &target);
+    static QString cacheFile(const Target &target);
+    static bool load(const QString &cacheFile, Entry *entry);
+    static bool save(const QString &cacheFile, const Entry &entry);
+
+    void download(const QString &key, const Target &target);
+    static void reply(QWebEngineUrlRequestJob *job, const Entry &entry);
+
+    QNetworkAccessManager m_network;
+
+    // cache key -> verified content
+    QHash<QString, Entry> m_entries;
+
+    // cache key -> jobs waiting for the download, one download per target
+    QHash<QString, QList<QPointer<QWebEngineUrlRequestJob>>> m_pending;
+
+    static const char *header;
+    static const quint32 version;
+};
+
+#endif // TARGETCACHE_HPP
@@ -0,0 +1,161 @@
+#include "TrafficProfiler.hpp"
+
+#include <Core/StreamingProviderStore.hpp>
+
+#include <QWebEngineUrlRequestInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+
+#include <algorithm>
+
+#include <QDebug>
+
+TrafficProfiler::TrafficProfiler()
+{
+    this->m_foldTimer.setSingleShot(true);
+    this->m_foldTimer.setInterval(0);
+    QObject::connect(&this->m_foldTimer, &QTimer::timeout, [this]{
+        this->fold();
+    });
+
+    this->m_timer.start();
+}
+
+void TrafficProfiler::record(const QString &host, int resourceType, int navigationType, Outcome outcome)
+{
+    // more requests than the event loop could keep up with
+    if (this->m_size == TrafficProfiler::capacity)
+        this->fold();
+
+    auto &sample = this->m_samples[std::size_t(this->m_size++)];
+    sample.msecs = this->m_timer.elapsed();
+    sample.host = host;
+    sample.resourceType = qint16(resourceType);
+    sample.navigationType = qint8(navigationType);
+    sample.outcome = outcome;
+
+    if (this->m_size >= TrafficProfiler::foldThreshold && !this->m_foldTimer.isActive())
+        this->m_foldTimer.start();
+}
+
+void TrafficProfiler::clear()
+{
+    this->m_foldTimer.stop();
+    this->m_size = 0;
+    this->m_requests = 0;
+    this->m_hosts.clear();
+    this->m_resourceTypes.clear();
+    this->m_navigationTypes.clear();
+    this->m_perSecond.clear();
+    this->m_timer.restart();
+}
+
+void TrafficProfiler::fold()
+{
+    for (auto i = 0; i < this->m_size; i++)
+    {
+        const auto &sample = this->m_samples[std::size_t(i)];
+
+        auto &host = this->m_hosts[sample.host];
+        host.requests++;
+        if (sample.outcome == Redirected)
+            host.redirected++;
+        else if (sample.outcome == Blocked)
+            host.blocked++;
+
+        this->m_resourceTypes[sample.resourceType]++;
+        this->m_navigationTypes[sample.navigationType]++;
+
+        const auto second = int(sample.msecs / 1000);
+        if (second >= this->m_perSecond.size())
+            this->m_perSecond.resize(second + 1);
+        this->m_perSecond[second]++;
+    }
+
+    this->m_requests += quint64(this->m_size);
+    this->m_size = 0;
+    this->m_foldTimer.stop();
+}
+
+QJsonObject TrafficProfiler::report()
+{
+    this->fold();
+
+    // most requested hosts first
+    QVector<QHash<QString, HostCount>::const_iterator> hosts;
+    hosts.reserve(this->m_hosts.size());
+    for (auto it = this->m_hosts.cbegin(); it != this->m_hosts.cend(); ++it)
+        hosts.append(it);
+    std::sort(hosts.begin(), hosts.end(), [](const QHash<QString, HostCount>::const_iterator &a,
+                                             const QHash<QString, HostCount>::const_iterator &b) {
+        return a.value().requests != b.value().requests ? a.value().requests > b.value().requests : a.key() < b.key();
+    });
+
+    QJsonArray hostCounts;
+    for (auto&& it : hosts)
+    {
+        hostCounts.append(QJsonObject{
+            {"host", it.key()},
+            {"requests", qint64(it.value().requests)},
+            {"redirected", qint64(it.value().redirected)},
+            {"blocked", qint64(it.value().blocked)},
+        });
+    }
+
+    QJsonObject resourceTypes;
+    for (auto it = this->m_resourceTypes.cbegin(); it != this->m_resourceTypes.cend(); ++it)
+        resourceTypes.insert(UrlInterceptorLink::resourceTypesToString(UrlInterceptorLink::resourceTypeBit(it.key())), qint64(it.value()));
+
+    QJsonObject navigationTypes;
+    for (auto it = this->m_navigationTypes.cbegin(); it != this->m_navigationTypes.cend(); ++it)
+        navigationTypes.insert(TrafficProfiler::navigationTypeName(it.key()), qint64(it.value()));
+
+    QJsonArray perSecond;
+    for (auto&& count : this->m_perSecond)
+        perSecond.append(qint64(count));
+
+    return QJsonObject{
+        {"requests", qint64(this->m_requests)},
+        {"seconds", qint64(this->m_timer.elapsed() / 1000)},
+        {"hosts", hostCounts},
+        {"resourceTypes", resourceTypes},
+        {"navigationTypes", navigationTypes},
+        {"requestsPerSecond", perSecond},
+    };
+}
+
+bool TrafficProfiler::writeReport(const QString &file)
+{
+    if (!QDir().mkpath(QFileInfo(file).absolutePath()))
+        return false;
+
+    QSaveFile out(file);
+    if (!out.open(QFile::WriteOnly) ||
+        out.write(QJsonDocument(this->report()).toJson()) == -1 ||
+        !out.commit())
+    {
+        qDebug() << "[Traffic Profiler] Error writing report to" << file;
+        return false;
+    }
+
+    qDebug() << "[Traffic Profiler]" << this->m_requests << "requests to" << this->m_hosts.size() << "hosts, report written to" << file;
+    return true;
+}
+
+QString TrafficProfiler::navigationTypeName(int navigationType)
+{
+    switch (navigationType)
+    {
+        case QWebEngineUrlRequestInfo::NavigationTypeLink:          return QStringLiteral("link");
+        case QWebEngineUrlRequestInfo::NavigationTypeTyped:         return QStringLiteral("typed");
+        case QWebEngineUrlRequestInfo::NavigationTypeFormSubmitted: return QStringLiteral("formsubmitted");
+        case QWebEngineUrlRequestInfo::NavigationTypeBackForward:   return QStringLiteral("backforward");
+        case QWebEngineUrlRequestInfo::NavigationTypeReload:        return QStringLiteral("reload");
+        case QWebEngineUrlRequestInfo::NavigationTypeRedirect:      return QStringLiteral("redirect");
+        case QWebEngineUrlRequestInfo::NavigationTypeOther:         return QStringLiteral("other");
+    }
+    return QString::number(navigationType);
+}
@@ -0,0 +1,85 @@
+#ifndef TRAFFICPROFILER_HPP
+#define TRAFFICPROFILER_HPP
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QJsonObject>
+
+#include <array>
+
+// Traffic profile of all requests a page makes, used to decide what to block or cache.
+//
+// record() only copies the request into a fixed-size sample buffer, the samples are
+// folded into the per host, per resource type, per navigation type and per second
+// counts from the event loop once the buffer is half full, or when a report is made.
+// Only a buffer filled up before the event loop got to it is folded within record().
+// Not thread-safe, per-page interceptors call record() on the UI thread.
+class TrafficProfiler
+{
+public:
+    TrafficProfiler();
+
+    enum Outcome : quint8 {
+        Passed,
+        Redirected,
+        Blocked,
+    };
+
+    void record(const QString &host, int resourceType, int navigationType, Outcome outcome);
+
+    // drop all samples and counts, restarts the clock
+    void clear();
+
+    inline quint64 requests() const
+    { return this->m_requests + quint64(this->m_size); }
+
+    //  > {"requests": n, "seconds": n,
+    //     "hosts": [{"host": "...", "requests": n, "redirected": n, "blocked": n}, ...],
+    //     "resourceTypes": {"script": n, ...}, "navigationTypes": {"link": n, ...},
+    //     "requestsPerSecond": [n, ...]}
+    // hosts are sorted by requests, most requested first
+    QJsonObject report();
+    bool writeReport(const QString &file);
+
+private:
+    struct Sample
+    {
+        qint64 msecs;
+        QString host;
+        qint16 resourceType;
+        qint8 navigationType;
+        Outcome outcome;
+    };
+
+    // reused after folding, a slot keeps its host until it's overwritten
+    static const int capacity = 4096;
+    static const int foldThreshold = capacity / 2;
+    std::array<Sample, capacity> m_samples;
+    int m_size = 0;
+
+    void fold();
+    QTimer m_foldTimer; // zero-timer, folds outside the request path
+
+    QElapsedTimer m_timer;
+
+    struct HostCount
+    {
+        quint64 requests = 0;
+        quint64 redirected = 0;
+        quint64 blocked = 0;
+    };
+
+    // folded counts
+    quint64 m_requests = 0;
+    QHash<QString, HostCount> m_hosts;
+    QHash<int, quint64> m_resourceTypes;
+    QHash<int, quint64> m_navigationTypes;
+    QVector<quint32> m_perSecond;
+
+    static QString navigationTypeName(int navigationType);
+};
+
+#endif // TRAFFICPROFILER_HPP
@@ -0,0 +1,536 @@
+#include "UrlInterceptorMatcher.hpp"
+#include "RegExpCompat.hpp"
+
+#include <QStringList>
+
+namespace {
+
+// literal a regular expression requires to match
+struct Literal
+{
+    QString host;      // "://host/" literal, compared against the hosts in the url
+    QString substring; // otherwise a plain substring of the url
+};
+
+// at least one of the literals must be present in the url
+using Requirement = QList<Literal>;
+
+// Extracts the required literals of a QRegExp pattern (RegExp syntax).
+// Conservative: whenever something can't be proven to be required
+// it is treated as arbitrary input.
+class LiteralExtractor
+{
+public:
+    explicit LiteralExtractor(const QString &pattern)
+        : pattern(pattern)
+    {}
+
+    // false if no requirement could be extracted for any of the alternatives
+    bool extract(Requirement *requirement)
+    {
+        return this->alternation(requirement) && this->pos == this->pattern.size();
+    }
+
+private:
+    const QString &pattern;
+    int pos = 0;
+
+    enum Quantifier {
+        None,
+        Repeated, // +
+        Optional, // * ? {m,n}
+    };
+
+    inline bool atEnd() const
+    { return this->pos >= this->pattern.size(); }
+    inline QChar current() const
+    { return this->pattern.at(this->pos); }
+
+    Quantifier quantifier()
+    {
+        if (this->atEnd())
+            return None;
+
+        switch (this->current().unicode())
+        {
+            case '+':
+                this->pos++;
+                return Repeated;
+            case '*':
+            case '?':
+                this->pos++;
+                return Optional;
+            case '{':
+                while (!this->atEnd() && this->current() != '}')
+                    this->pos++;
+                if (!this->atEnd())
+                    this->pos++;
+                return Optional;
+        }
+
+        return None;
+    }
+
+    // alternative ('|' alternative)* until ')' or the end
+    bool alternation(Requirement *requirement)
+    {
+        auto valid = true;
+        for (;;)
+        {
+            if (!this->sequence(requirement))
+                valid = false;
+
+            if (!this->atEnd() && this->current() == '|')
+            {
+                this->pos++;
+                continue;
+            }
+            break;
+        }
+        return valid;
+    }
+
+    bool sequence(Requirement *requirement)
+    {
+        QStringList runs;
+        QList<Requirement> groups;
+        QString run;
+
+        const auto flush = [&]{
+            if (!run.isEmpty())
+                runs.append(run);
+            run.clear();
+        };
+
+        while (!this->atEnd() && this->current() != '|' && this->current() != ')')
+        {
+            const auto c = this->current();
+
+            // group
+            if (c == '(')
+            {
+                this->pos++;
+                auto lookahead = false;
+                if (this->pattern.midRef(this->pos, 2) == QLatin1String("?=") ||
+                    this->pattern.midRef(this->pos, 2) == QLatin1String("?!"))
+                {
+                    lookahead = true;
+                    this->pos += 2;
+                }
+                else if (this->pattern.midRef(this->pos, 2) == QLatin1String("?:"))
+                {
+                    this->pos += 2;
+                }
+
+                Requirement group;
+                const auto valid = this->alternation(&group);
+                if (this->atEnd())
+                    return false; // unbalanced
+                this->pos++; // ')'
+
+                flush();
+                if (this->quantifier() != Optional && valid && !lookahead)
+                    groups.append(group);
+                continue;
+            }
+
+            // character class
+            if (c == '[')
+            {
+                this->pos++;
+                if (!this->atEnd() && this->current() == '^')
+                    this->pos++;
+                if (!this->atEnd() && this->current() == ']')
+                    this->pos++;
+                while (!this->atEnd() && this->current() != ']')
+                    this->pos += this->current() == '\\' ? 2 : 1;
+                this->pos++;
+
+                flush();
+                this->quantifier();
+                continue;
+            }
+
+            // wildcard and anchors
+            if (c == '.' || c == '^' || c == '$')
+            {
+                this->pos++;
+                flush();
+                this->quantifier();
+                continue;
+            }
+
+            QChar literal = c;
+            if (c == '\\')
+            {
+                if (this->pos + 1 >= this->pattern.size())
+                    return false;
+
+                const auto escaped = this->pattern.at(this->pos + 1);
+                this->pos += 2;
+
+                // character classes, assertions, back-references and character codes
+                if (escaped.isLetterOrNumber())
+                {
+                    auto digits = escaped == 'x' ? 4 : escaped == '0' ? 3 : 0;
+                    while (digits-- > 0 && !this->atEnd() && this->current().isLetterOrNumber())
+                        this->pos++;
+
+                    flush();
+                    this->quantifier();
+                    continue;
+                }
+
+                literal = escaped;
+            }
+            else if (c == '*' || c == '+' || c == '?' || c == '{')
+            {
+                this->pos++;
+                flush();
+                continue;
+            }
+            else
+            {
+                this->pos++;
+            }
+
+            switch (this->quantifier())
+            {
+                case None:
+                    run.append(literal);
+                    break;
+                case Repeated:
+                    run.append(literal);
+                    flush();
+                    break;
+                case Optional:
+                    flush();
+                    break;
+            }
+        }
+        flush();
+
+        // prefer a host, then a long enough substring, then the requirement of a group
+        QString longest;
+        for (auto&& i : runs)
+        {
+            const auto scheme = i.indexOf(QLatin1String("://"));
+            const auto slash = scheme == -1 ? -1 : i.indexOf('/', scheme + 3);
+            if (slash > scheme + 3)
+            {
+                requirement->append(Literal{i.mid(scheme + 3, slash - scheme - 3), QString()});
+                return true;
+            }
+
+            if (i.size() > longest.size())
+                longest = i;
+        }
+
+        if (longest.size() >= 3 || (groups.isEmpty() && !longest.isEmpty()))
+        {
+            requirement->append(Literal{QString(), longest});
+            return true;
+        }
+
+        if (!groups.isEmpty())
+        {
+            requirement->append(groups.first());
+            return true;
+        }
+
+        return false;
+    }
+};
+
+}
+
+UrlInterceptorMatcher::UrlInterceptorMatcher()
+{
+}
+
+UrlInterceptorMatcher::UrlInterceptorMatcher(const QList<UrlInterceptorLink> &urlInterceptorLinks, Engine engine)
+    : m_links(urlInterceptorLinks)
+{
+    QStringList alternatives, translatedAlternatives;
+    auto group = 1, expressionGroup = 1;
+    auto translatable = true;
+
+    this->m_groups.fill(-1, this->m_links.size());
+    this->m_expressionGroups.fill(-1, this->m_links.size());
+    this->m_expressions.resize(this->m_links.size());
+    this->m_translated.fill(false, this->m_links.size());
+
+    for (auto i = 0; i < this->m_links.size(); i++)
+    {
+        const auto &pattern = this->m_links.at(i).pattern;
+        this->m_coveredTypes |= this->m_links.at(i).resourceTypes;
+
+        if (this->m_links.at(i).match.isValid())
+        {
+            this->m_structured.append(i);
+            continue;
+        }
+
+        if (this->m_firstPattern == -1)
+            this->m_firstPattern = i;
+
+        const auto translated = engine == RegularExpression ? RegExpCompat::translate(pattern) : QString();
+        if (!translated.isNull())
+            this->m_translated[i] = RegExpCompat::exactMatch(translated, RegExpCompat::options(pattern), &this->m_expressions[i]);
+
+        if (!UrlInterceptorMatcher::isCombinable(pattern))
+        {
+            this->m_standalone.append(i);
+            continue;
+        }
+
+        // every rule gets its own capture group, followed by the groups of the rule itself
+        alternatives.append('(' + pattern.pattern() + ')');
+        this->m_groups[i] = group;
+        group += 1 + pattern.captureCount();
+
+        if (this->m_translated.at(i))
+        {
+            translatedAlternatives.append('(' + translated + ')');
+            this->m_expressionGroups[i] = expressionGroup;
+            expressionGroup += 1 + this->m_expressions.at(i).captureCount();
+        }
+        else
+        {
+            translatable = false;
+        }
+    }
+
+    // prefilter, every rule needs at least one required literal
+    this->m_prefilter = this->m_firstPattern != -1;
+    for (auto&& link : this->m_links)
+    {
+        if (link.match.isValid())
+            continue;
+
+        Requirement requirement;
+        if (!link.pattern.isValid() ||
+            link.pattern.patternSyntax() != QRegExp::RegExp ||
+            link.pattern.caseSensitivity() != Qt::CaseSensitive ||
+            !LiteralExtractor(link.pattern.pattern()).extract(&requirement) ||
+            requirement.isEmpty())
+        {
+            this->m_prefilter = false;
+            break;
+        }
+
+        for (auto&& literal : requirement)
+        {
+            if (!literal.host.isEmpty())
+                this->m_hosts.insert(literal.host);
+            else if (!this->m_substrings.contains(literal.substring))
+                this->m_substrings.append(literal.substring);
+        }
+    }
+
+    if (alternatives.isEmpty())
+        return;
+
+    // combinable rules share the default options
+    if (translatable)
+    {
+        this->m_hasExpression = RegExpCompat::exactMatch(translatedAlternatives.join('|'),
+                                                         RegExpCompat::options(QRegExp()),
+                                                         &this->m_expression);
+        if (this->m_hasExpression)
+            return;
+    }
+
+    this->m_combined = QRegExp(alternatives.join('|'));
+    if (!this->m_combined.isValid())
+    {
+        // shouldn't happen, match every rule one by one
+        this->m_combined = QRegExp();
+        this->m_groups.fill(-1);
+        this->m_standalone.clear();
+        for (auto i = 0; i < this->m_links.size(); i++)
+            if (!this->m_links.at(i).match.isValid())
+                this->m_standalone.append(i);
+    }
+}
+
+int UrlInterceptorMatcher::match(const QUrl &url, quint32 resourceType) const
+{
+    if (!this->covers(resourceType))
+        return -1;
+
+    auto first = -1;
+    for (auto&& i : this->m_structured)
+    {
+        if (this->applies(i, resourceType) && this->m_links.at(i).match.matches(url))
+        {
+            first = i;
+            break;
+        }
+    }
+
+    // serialize the url once, only if a pattern rule comes first
+    if (this->m_firstPattern != -1 && (first == -1 || this->m_firstPattern < first))
+    {
+        const auto pattern = this->matchPattern(url.toString(), first == -1 ? this->m_links.size() : first, resourceType);
+        if (pattern != -1)
+            return pattern;
+    }
+
+    return first;
+}
+
+int UrlInterceptorMatcher::matchPattern(const QString &url, int limit, quint32 resourceType) const
+{
+    if (!this->mayMatch(url))
+        return -1;
+
+    auto first = -1;
+
+    if (this->m_hasExpression)
+    {
+        // alternatives are tried in order, the reported one is the first matching rule
+        const auto match = this->m_expression.match(url);
+        if (match.hasMatch())
+        {
+            for (auto i = 0; i < this->m_links.size(); i++)
+            {
+                if (this->m_expressionGroups.at(i) != -1 && match.capturedStart(this->m_expressionGroups.at(i)) != -1)
+                {
+                    first = i;
+                    break;
+                }
+            }
+        }
+    }
+    else if (!this->m_combined.isEmpty())
+    {
+        const auto &combined = this->m_combined;
+        if (combined.exactMatch(url))
+        {
+            // QRegExp reports one of the matching alternatives, which isn't necessarily the first one
+            auto reported = this->m_links.size();
+            for (auto i = 0; i < this->m_links.size(); i++)
+            {
+                if (this->m_groups.at(i) != -1 && combined.pos(this->m_groups.at(i)) != -1)
+                {
+                    reported = i;
+                    break;
+                }
+            }
+
+            // verify earlier rules, only happens on a match
+            for (auto i = 0; i < reported; i++)
+            {
+                if (this->m_groups.at(i) != -1 && this->applies(i, resourceType) && this->exactMatch(i, url))
+                {
+                    first = i;
+                    break;
+                }
+            }
+            if (first == -1 && reported < this->m_links.size())
+                first = reported;
+        }
+    }
+
+    // reported rule is restricted to other resource types, try the following combined rules
+    if (first != -1 && !this->applies(first, resourceType))
+    {
+        const auto reported = first;
+        first = -1;
+        for (auto i = reported + 1; i < limit && i < this->m_links.size(); i++)
+        {
+            if (this->m_groups.at(i) != -1 && this->applies(i, resourceType) && this->exactMatch(i, url))
+            {
+                first = i;
+                break;
+            }
+        }
+    }
+
+    if (first == -1 || first > limit)
+        first = limit;
+
+    for (auto&& i : this->m_standalone)
+    {
+        if (i >= first)
+            break;
+        if (this->applies(i, resourceType) && this->exactMatch(i, url))
+            return i;
+    }
+
+    return first < limit ? first : -1;
+}
+
+QStringList UrlInterceptorMatcher::captures(int rule, const QUrl &url) const
+{
+    if (this->m_links.at(rule).match.isValid())
+        return QStringList();
+
+    // the rule on its own, group numbers differ in the combined expression
+    const auto str = url.toString();
+    if (this->m_translated.at(rule))
+    {
+        const auto match = this->m_expressions.at(rule).match(str);
+        return match.hasMatch() ? match.capturedTexts() : QStringList();
+    }
+
+    const auto &pattern = this->m_links.at(rule).pattern;
+    return pattern.exactMatch(str) ? pattern.capturedTexts() : QStringList();
+}
+
+bool UrlInterceptorMatcher::exactMatch(int rule, const QString &url) const
+{
+    if (this->m_translated.at(rule))
+        return this->m_expressions.at(rule).match(url).hasMatch();
+
+    return this->m_links.at(rule).pattern.exactMatch(url);
+}
+
+bool UrlInterceptorMatcher::mayMatch(const QString &url) const
+{
+    if (!this->m_prefilter)
+        return this->m_firstPattern != -1;
+
+    // hosts following every "://" in the url, usually just one
+    if (!this->m_hosts.isEmpty())
+    {
+        for (auto scheme = url.indexOf(QLatin1String("://")); scheme != -1; scheme = url.indexOf(QLatin1String("://"), scheme + 3))
+        {
+            const auto slash = url.indexOf('/', scheme + 3);
+            if (slash == -1)
+                break;
+            if (this->m_hosts.contains(url.mid(scheme + 3, slash - scheme - 3)))
+                return true;
+        }
+    }
+
+    for (auto&& substring : this->m_substrings)
+        if (url.contains(substring))
+            return true;
+
+    return false;
+}
+
+bool UrlInterceptorMatcher::isCombinable(const QRegExp &pattern)
+{
+    if (!pattern.isValid() || pattern.isEmpty() ||
+        pattern.patternSyntax() != QRegExp::RegExp ||
+        pattern.caseSensitivity() != Qt::CaseSensitive ||
+        pattern.isMinimal())
+        return false;
+
+    // back-references would point to the wrong group in the combined expression
+    const auto &str = pattern.pattern();
+    for (auto i = 0; i < str.size() - 1; i++)
+    {
+        if (str.at(i) == '\\')
+        {
+            if (str.at(i + 1) >= '1' && str.at(i + 1) <= '9')
+                return false;
+            i++; // skip escaped character
+        }
+    }
+
+    return true;
+}
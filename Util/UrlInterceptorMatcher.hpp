@@ -0,0 +1,101 @@
+#ifndef URLINTERCEPTORMATCHER_HPP
+#define URLINTERCEPTORMATCHER_HPP
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QRegExp>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+#include <Core/StreamingProviderStore.hpp>
+
+// Compiles the URL interceptor patterns into a single combined regular expression,
+// so a request URL is matched against all rules in one pass.
+// First match wins, same as trying every pattern in order.
+//
+// Literals every rule requires (e.g. "://assets.nflxext.com/") are extracted
+// at compile time, URLs which can't contain any of them are rejected with
+// a host lookup and a few substring searches, without running any regex.
+//
+// Structured rules (urlInterceptorMatch) are matched on the QUrl components,
+// the url is only serialized if a pattern rule may match before them.
+//
+// Patterns are matched with QRegularExpression (JIT compiled, see RegExpCompat)
+// unless they can't be translated, then QRegExp is used for those rules.
+//
+// Rules restricted to resource types (urlInterceptorResourceTypes) are skipped
+// for requests of other types, covers() tells if any rule applies at all.
+//
+// Not thread-safe, QRegExp keeps the match state in the object. Only used on
+// the UI thread by the per-page interceptor (see UrlInterceptorRules).
+class UrlInterceptorMatcher
+{
+public:
+    enum Engine {
+        RegularExpression,
+        LegacyRegExp, // QRegExp only, for comparison
+    };
+
+    UrlInterceptorMatcher();
+    explicit UrlInterceptorMatcher(const QList<UrlInterceptorLink> &urlInterceptorLinks, Engine engine = RegularExpression);
+
+    // index of the first rule matching the given url and resource type, -1 if none
+    // resource type is a bit of UrlInterceptorLink::resourceTypeBit()
+    int match(const QUrl &url, quint32 resourceType = UrlInterceptorLink::AllResourceTypes) const;
+
+    // true if at least one rule applies to the given resource type
+    inline bool covers(quint32 resourceType) const
+    { return this->m_coveredTypes & resourceType; }
+
+    // captured texts of the given pattern rule for the url, empty if it doesn't match
+    // the first one is the whole url, structured rules don't capture anything
+    QStringList captures(int rule, const QUrl &url) const;
+
+    inline const UrlInterceptorLink &link(int index) const
+    { return this->m_links.at(index); }
+    inline int count() const
+    { return this->m_links.size(); }
+
+private:
+    QList<UrlInterceptorLink> m_links;
+    quint32 m_coveredTypes = 0; // resource types of all rules
+
+    inline bool applies(int rule, quint32 resourceType) const
+    { return this->m_links.at(rule).resourceTypes & resourceType; }
+
+    QVector<int> m_structured; // rules matched on the QUrl components
+    int m_firstPattern = -1;   // first rule which needs the serialized url
+
+    // first pattern rule before the given limit matching the url, -1 if none
+    int matchPattern(const QString &url, int limit, quint32 resourceType) const;
+
+    // all rules which can be combined, one capture group per rule
+    QRegExp m_combined;
+    QVector<int> m_groups; // rule -> capture group in m_combined, -1 if not combined
+
+    // same for QRegularExpression, alternatives are tried in order
+    QRegularExpression m_expression;
+    bool m_hasExpression = false;
+    QVector<int> m_expressionGroups;
+
+    // translated rules, for rules which can't be combined
+    QVector<QRegularExpression> m_expressions;
+    QVector<bool> m_translated;
+    bool exactMatch(int rule, const QString &url) const;
+
+    // rules which can't be combined (back-references, non default options)
+    QVector<int> m_standalone;
+
+    // prefilter, only valid if every rule has at least one required literal
+    bool m_prefilter = false;
+    QSet<QString> m_hosts;    // "://host/" literals
+    QStringList m_substrings; // other literals
+    bool mayMatch(const QString &url) const;
+
+    static bool isCombinable(const QRegExp &pattern);
+};
+
+#endif // URLINTERCEPTORMATCHER_HPP
@@ -0,0 +1,206 @@
+#include "UrlInterceptorRules.hpp"
+
+#include <Core/ConfigManager.hpp>
+
+#include <QFileInfo>
+
+#include <QDebug>
+
+UrlInterceptorRules::UrlInterceptorRules()
+{
+}
+
+UrlInterceptorRules::UrlInterceptorRules(const QList<UrlInterceptorLink> &urlInterceptorLinks, const QString &httpAcceptLanguage)
+    : matcher(urlInterceptorLinks)
+{
+    this->compileTargets();
+    this->compileHeaders(httpAcceptLanguage, QList<HttpHeaderRule>());
+}
+
+UrlInterceptorRules::UrlInterceptorRules(const Provider &provider)
+    : matcher(provider.urlInterceptor ? provider.urlInterceptorLinks : QList<UrlInterceptorLink>())
+{
+    this->compileTargets();
+    this->compileHeaders(provider.urlInterceptor ? provider.httpAcceptLanguage : QString(), provider.httpHeaders);
+
+    if (QFileInfo::exists(Config()->blockListFile()))
+        this->m_blockList.addFile(Config()->blockListFile());
+
+    // relative to the provider file, same as scripts
+    for (auto&& blockList : provider.blockLists)
+        this->m_blockList.addFile(QFileInfo(blockList).isAbsolute() ? blockList : provider.path + '/' + blockList);
+
+    for (auto&& domain : provider.blockedDomains)
+        this->m_blockList.add(domain);
+
+    this->m_blockList.compile();
+
+    if (!this->m_blockList.isEmpty())
+        qDebug() << "[URL Interceptor] Blocking" << this->m_blockList.count() << "domains for" << provider.id;
+}
+
+void UrlInterceptorRules::compileTargets()
+{
+    this->m_targets.reserve(this->matcher.count());
+    for (auto i = 0; i < this->matcher.count(); i++)
+        this->m_targets.append(UrlInterceptorRules::compileTarget(this->matcher.link(i).target));
+    this->m_hits.fill(0, this->matcher.count());
+}
+
+void UrlInterceptorRules::compileHeaders(const QString &httpAcceptLanguage, const QList<HttpHeaderRule> &rules)
+{
+    // headers of every pattern in the order of appearance
+    HttpHeaders global;
+    QHash<QString, HttpHeaders> hosts, subdomains;
+
+    if (!httpAcceptLanguage.isEmpty())
+        global.append(qMakePair(QByteArrayLiteral("Accept-Language"), httpAcceptLanguage.toUtf8()));
+
+    for (auto&& rule : rules)
+    {
+        auto &headers = rule.host.isEmpty() ? global : (rule.subdomains ? subdomains[rule.host] : hosts[rule.host]);
+        headers.append(qMakePair(rule.name.toLatin1(), rule.clear ? QByteArray() : rule.value.toUtf8()));
+    }
+
+    UrlInterceptorRules::mergeHeaders(&this->m_globalHeaders, global);
+
+    // global < *.parent domains (outermost first) < own pattern
+    const auto merged = [&](const QString &domain, const HttpHeaders &own) {
+        auto headers = this->m_globalHeaders;
+        for (auto pos = domain.lastIndexOf('.'); pos > 0; pos = domain.lastIndexOf('.', pos - 1))
+        {
+            const auto it = subdomains.constFind(domain.mid(pos + 1));
+            if (it != subdomains.cend())
+                UrlInterceptorRules::mergeHeaders(&headers, it.value());
+        }
+        UrlInterceptorRules::mergeHeaders(&headers, own);
+        return headers;
+    };
+
+    for (auto it = subdomains.cbegin(); it != subdomains.cend(); ++it)
+        this->m_subdomainHeaders.insert(it.key(), merged(it.key(), it.value()));
+    for (auto it = hosts.cbegin(); it != hosts.cend(); ++it)
+        this->m_hostHeaders.insert(it.key(), merged(it.key(), it.value()));
+}
+
+void UrlInterceptorRules::mergeHeaders(HttpHeaders *headers, const HttpHeaders &rules)
+{
+    // the later rule wins, header names are case-insensitive
+    for (auto&& rule : rules)
+    {
+        auto found = false;
+        for (auto&& header : *headers)
+        {
+            if (qstricmp(header.first.constData(), rule.first.constData()) == 0)
+            {
+                header.second = rule.second;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            headers->append(rule);
+    }
+}
+
+const UrlInterceptorRules::HttpHeaders &UrlInterceptorRules::httpHeaders(const QString &host) const
+{
+    if (!this->m_hostHeaders.isEmpty())
+    {
+        const auto it = this->m_hostHeaders.constFind(host);
+        if (it != this->m_hostHeaders.cend())
+            return it.value();
+    }
+
+    // most specific parent domain first, without copying the host
+    if (!this->m_subdomainHeaders.isEmpty())
+    {
+        for (auto pos = host.indexOf('.'); pos != -1; pos = host.indexOf('.', pos + 1))
+        {
+            const auto it = this->m_subdomainHeaders.constFind(QString::fromRawData(host.constData() + pos + 1, host.size() - pos - 1));
+            if (it != this->m_subdomainHeaders.cend())
+                return it.value();
+        }
+    }
+
+    return this->m_globalHeaders;
+}
+
+QUrl UrlInterceptorRules::decide(const QUrl &url, quint32 resourceType, bool *cached) const
+{
+    if (cached)
+        (*cached) = false;
+
+    if (!this->matcher.covers(resourceType))
+        return QUrl();
+
+    const auto key = qMakePair(url, resourceType);
+    Decision decision;
+    if (this->m_cache.find(key, &decision))
+    {
+        if (cached)
+            (*cached) = true;
+    }
+    else
+    {
+        decision.rule = this->matcher.match(url, resourceType);
+        if (decision.rule != -1)
+            decision.target = this->substitute(decision.rule, url);
+        this->m_cache.insert(key, decision);
+    }
+
+    if (decision.rule != -1)
+        this->m_hits[decision.rule]++;
+    return decision.target;
+}
+
+QUrl UrlInterceptorRules::resolve(const QUrl &url, quint32 resourceType) const
+{
+    const auto rule = this->matcher.match(url, resourceType);
+    return rule != -1 ? this->substitute(rule, url) : QUrl();
+}
+
+UrlInterceptorRules::Target UrlInterceptorRules::compileTarget(const QUrl &target)
+{
+    Target compiled;
+
+    // backslashes are always percent-encoded, "\1" is "%5C1" here
+    const auto str = target.toString(QUrl::FullyEncoded);
+    QString part;
+    for (auto i = 0; i < str.size(); i++)
+    {
+        if (str.at(i) == '%' && i + 3 < str.size() &&
+            str.midRef(i + 1, 2).compare(QLatin1String("5C"), Qt::CaseInsensitive) == 0 &&
+            str.at(i + 3).isDigit())
+        {
+            compiled.parts.append(part);
+            compiled.references.append(str.at(i + 3).digitValue());
+            part.clear();
+            i += 3;
+            continue;
+        }
+        part.append(str.at(i));
+    }
+    compiled.parts.append(part);
+
+    return compiled;
+}
+
+QUrl UrlInterceptorRules::substitute(int rule, const QUrl &url) const
+{
+    const auto &compiled = this->m_targets.at(rule);
+    if (compiled.references.isEmpty())
+        return this->matcher.link(rule).target;
+
+    // only evaluated on a match, the result is cached
+    const auto captures = this->matcher.captures(rule, url);
+
+    QString str = compiled.parts.first();
+    for (auto i = 0; i < compiled.references.size(); i++)
+    {
+        str.append(captures.value(compiled.references.at(i)));
+        str.append(compiled.parts.at(i + 1));
+    }
+
+    return QUrl(str);
+}
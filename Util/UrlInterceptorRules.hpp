@@ -0,0 +1,117 @@
+#ifndef URLINTERCEPTORRULES_HPP
+#define URLINTERCEPTORRULES_HPP
+
+#include <QList>
+#include <QUrl>
+#include <QString>
+#include <QByteArray>
+#include <QPair>
+#include <QVector>
+#include <QStringList>
+#include <QHash>
+
+#include <Core/StreamingProviderStore.hpp>
+
+#include "UrlInterceptorMatcher.hpp"
+#include "DomainBlockList.hpp"
+#include "LruCache.hpp"
+
+// Compiled URL interceptor rules, headers and block list of a provider, built once and never modified,
+// only the decision cache and the hit counters change. Not thread-safe: the per-page interceptor
+// calls decide() on the UI thread, the same thread which replaces the rules (see UrlRequestInterceptor).
+//
+// Targets of pattern rules can refer to the capture groups of the pattern,
+// \0 to \9, \0 being the whole url.
+//  > urlInterceptorPattern:.*://img\.example\.com/(\d+)/large/(.*)
+//  > urlInterceptorTarget:https://img.example.com/\1/small/\2
+//
+// Header rules are encoded once and merged per host pattern, a request gets
+// a single ready to send list from a host lookup (exact host, then parent domains).
+class UrlInterceptorRules
+{
+public:
+    UrlInterceptorRules();
+    explicit UrlInterceptorRules(const QList<UrlInterceptorLink> &urlInterceptorLinks, const QString &httpAcceptLanguage = QString());
+
+    // all request rules of the provider, interceptor rules only if enabled
+    // block lists are read from disk, including the global block list
+    explicit UrlInterceptorRules(const Provider &provider);
+
+    // true if the host is on one of the block lists
+    inline bool blocks(const QString &host) const
+    { return this->m_blockList.contains(host); }
+
+    // redirect target for the request, empty to pass through
+    // resource type is a bit of UrlInterceptorLink::resourceTypeBit()
+    // cached is set to true if the decision was taken from the cache
+    QUrl decide(const QUrl &url, quint32 resourceType, bool *cached = nullptr) const;
+
+    // same as decide() but always matched, neither cached nor counted
+    // reference for the cached decisions (InterceptorReplay)
+    QUrl resolve(const QUrl &url, quint32 resourceType) const;
+
+    // true if at least one rule applies to the given resource type
+    inline bool covers(quint32 resourceType) const
+    { return this->matcher.covers(resourceType); }
+
+    inline bool isEmpty() const
+    { return this->matcher.count() == 0; }
+    inline int count() const
+    { return this->matcher.count(); }
+    inline const UrlInterceptorLink &link(int rule) const
+    { return this->matcher.link(rule); }
+
+    // requests redirected by the rule, cached decisions included
+    inline quint64 hits(int rule) const
+    { return this->m_hits.at(rule); }
+
+    // header name and value pairs, cleared headers have an empty value
+    // QWebEngineUrlRequestInfo can't remove headers, they're sent empty
+    using HttpHeaders = QVector<QPair<QByteArray, QByteArray>>;
+
+    // headers for requests to the host, Accept-Language included
+    const HttpHeaders &httpHeaders(const QString &host) const;
+
+    inline bool hasHttpHeaders() const
+    { return !this->m_globalHeaders.isEmpty() || !this->m_hostHeaders.isEmpty() || !this->m_subdomainHeaders.isEmpty(); }
+
+private:
+    const UrlInterceptorMatcher matcher;
+    DomainBlockList m_blockList;
+
+    void compileTargets();
+
+    // every list already contains the headers of the less specific patterns
+    HttpHeaders m_globalHeaders;
+    QHash<QString, HttpHeaders> m_hostHeaders;      // host -> headers
+    QHash<QString, HttpHeaders> m_subdomainHeaders; // domain of "*.domain" -> headers
+
+    void compileHeaders(const QString &httpAcceptLanguage, const QList<HttpHeaderRule> &rules);
+    static void mergeHeaders(HttpHeaders *headers, const HttpHeaders &rules);
+
+    // target of a rule, literal parts and capture group references alternate
+    struct Target
+    {
+        QStringList parts; // one more than references
+        QVector<int> references;
+    };
+    QVector<Target> m_targets;
+
+    static Target compileTarget(const QUrl &target);
+    QUrl substitute(int rule, const QUrl &url) const;
+
+    // one counter per rule, only incremented
+    mutable QVector<quint64> m_hits;
+
+    struct Decision
+    {
+        QUrl target; // empty = pass through
+        int rule = -1;
+    };
+
+    // request url and resource type -> decision
+    // player and asset urls are requested over and over again
+    mutable LruCache<QPair<QUrl, quint32>, Decision> m_cache{1024};
+};
+
+#endif // URLINTERCEPTORRULES_HPP
@@ -1,38 +1,152 @@
 #include "UrlRequestInterceptor.hpp"
 
-#include <QRegExp>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
 #include <QDebug>
 
 UrlRequestInterceptor::UrlRequestInterceptor(QObject *parent)
-    : QWebEngineUrlRequestInterceptor(parent)
+    : QWebEngineUrlRequestInterceptor(parent),
+      m_rules(std::make_shared<const UrlInterceptorRules>())
 {
 }
 
 UrlRequestInterceptor::UrlRequestInterceptor(const QList<UrlInterceptorLink> &urlInterceptorLinks,
                                              const QString &httpAcceptLanguage,
                                              QObject *parent)
-    : QWebEngineUrlRequestInterceptor(parent)
+    : QWebEngineUrlRequestInterceptor(parent),
+      m_rules(std::make_shared<const UrlInterceptorRules>(urlInterceptorLinks, httpAcceptLanguage))
 {
-    this->urlInterceptorLinks = urlInterceptorLinks;
-    this->httpAcceptLanguage = httpAcceptLanguage;
+}
+
+UrlRequestInterceptor::~UrlRequestInterceptor()
+{
+    const auto requests = this->requests();
+    const auto nsecs = this->interceptNsecs();
+    qDebug() << "[URL Interceptor]" << requests << "requests," << this->m_redirects << "redirects,"
+             << this->m_blocked << "blocked,"
+             << nsecs / 1000 << "us total," << (requests ? nsecs / requests : 0) << "ns per request,"
+             << "p99" << this->m_latency.percentile(99) << "ns";
+    qDebug() << "[URL Interceptor] Decision cache:" << this->m_cacheHits << "hits," << this->m_cacheMisses << "misses";
+}
+
+void UrlRequestInterceptor::setUrlInterceptorLinks(const QList<UrlInterceptorLink> &urlInterceptorLinks, const QString &httpAcceptLanguage)
+{
+    // compile before swapping, requests keep using the old rules meanwhile
+    this->setRules(std::make_shared<const UrlInterceptorRules>(urlInterceptorLinks, httpAcceptLanguage));
+}
+
+void UrlRequestInterceptor::setRules(const std::shared_ptr<const UrlInterceptorRules> &rules)
+{
+    Q_ASSERT(QThread::currentThread() == this->thread());
+
+    // same thread as interceptRequest(), no request is using the old rules
+    this->m_rules = rules ? rules : std::make_shared<const UrlInterceptorRules>();
+}
+
+QJsonObject UrlRequestInterceptor::statistics() const
+{
+    const auto &rules = this->m_rules;
+
+    QJsonArray ruleHits;
+    for (auto i = 0; i < rules->count(); i++)
+    {
+        const auto &link = rules->link(i);
+        ruleHits.append(QJsonObject{
+            {"rule", link.match.isValid() ? QString(link.match) : link.pattern.pattern()},
+            {"target", link.target.toString()},
+            {"hits", qint64(rules->hits(i))},
+        });
+    }
+
+    return QJsonObject{
+        {"requests", qint64(this->requests())},
+        {"redirects", qint64(this->m_redirects)},
+        {"blocked", qint64(this->m_blocked)},
+        {"cacheHits", qint64(this->m_cacheHits)},
+        {"cacheMisses", qint64(this->m_cacheMisses)},
+        {"latency", this->m_latency.toJson()},
+        {"rules", ruleHits},
+    };
+}
+
+bool UrlRequestInterceptor::writeStatistics(const QString &file) const
+{
+    if (!QDir().mkpath(QFileInfo(file).absolutePath()))
+        return false;
+
+    QSaveFile out(file);
+    if (!out.open(QFile::WriteOnly) ||
+        out.write(QJsonDocument(this->statistics()).toJson()) == -1 ||
+        !out.commit())
+    {
+        qDebug() << "[URL Interceptor] Error writing statistics to" << file;
+        return false;
+    }
+
+    qDebug() << "[URL Interceptor] Statistics written to" << file;
+    return true;
+}
+
+void UrlRequestInterceptor::recordTrace(const QString &file)
+{
+    this->m_trace = std::make_unique<RequestTrace>(file);
 }
 
 void UrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info)
 {
-    for (auto&& url : this->urlInterceptorLinks)
+    // not part of the measured time
+    if (this->m_trace)
+        this->m_trace->record(info.requestUrl(), info.resourceType());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Q_ASSERT(QThread::currentThread() == this->thread());
+
+    const auto &rules = this->m_rules;
+    const auto host = info.requestUrl().host();
+
+    // telemetry, ads, ...
+    if (rules->blocks(host))
     {
-        // too spammy, just show matches
-        //qDebug() << "[URL Interceptor] Trying: " << url.pattern;
-        if (url.pattern.exactMatch(info.requestUrl().toString()))
-        {
-            qDebug() << "[URL Interceptor] Match! -> " << url.target;
-            info.redirect(url.target);
-            return;
-        }
+        this->m_blocked++;
+        info.block(true);
+
+        this->m_latency.record(quint64(timer.nsecsElapsed()));
+        this->m_traffic.record(host, info.resourceType(), info.navigationType(), TrafficProfiler::Blocked);
+        return;
     }
 
-    if (!this->httpAcceptLanguage.isEmpty())
+    const auto resourceType = UrlInterceptorLink::resourceTypeBit(info.resourceType());
+
+    // no rule for this resource type (images, media segments, ...), skip the cache too
+    QUrl target;
+    if (rules->covers(resourceType))
     {
-        info.setHttpHeader("Accept-Language", this->httpAcceptLanguage.toUtf8());
+        bool cached = false;
+        target = rules->decide(info.requestUrl(), resourceType, &cached);
+        cached ? this->m_cacheHits++ : this->m_cacheMisses++;
     }
+
+    if (!target.isEmpty())
+    {
+        this->m_redirects++;
+        info.redirect(target);
+    }
+    else if (rules->hasHttpHeaders())
+    {
+        // encoded when the rules were compiled
+        for (auto&& header : rules->httpHeaders(host))
+            info.setHttpHeader(header.first, header.second);
+    }
+
+    // the profiler isn't part of the measured time
+    this->m_latency.record(quint64(timer.nsecsElapsed()));
+    this->m_traffic.record(host, info.resourceType(), info.navigationType(),
+                           target.isEmpty() ? TrafficProfiler::Passed : TrafficProfiler::Redirected);
 }
@@ -4,6 +4,26 @@
 #include <QWebEngineUrlRequestInterceptor>
 #include <Core/StreamingProviderStore.hpp>
 
+#include "UrlInterceptorRules.hpp"
+#include "LatencyHistogram.hpp"
+#include "TrafficProfiler.hpp"
+#include "RequestTrace.hpp"
+
+#include <QJsonObject>
+
+#include <memory>
+
+// Since Qt 5.13 interceptors run on the UI thread, interceptRequest() only does
+// a cached lookup in the compiled rules and doesn't log anything per request.
+// Instead it counts rule hits and records its own duration in a latency histogram,
+// see statistics(). A summary is logged when the interceptor is destroyed.
+//
+// The interceptor is installed once, the rules are replaced as a whole.
+// Requests always see either the old or the new rules, never none.
+//
+// Interception and rule changes both run on the UI thread (per-page interceptor,
+// setRules() is only called by the BrowserWindow), nothing on the request path is locked.
+// Both assert the thread affinity in debug builds.
 class UrlRequestInterceptor : public QWebEngineUrlRequestInterceptor
 {
     Q_OBJECT
@@ -11,11 +31,52 @@ class UrlRequestInterceptor : public QWebEngineUrlRequestInterceptor
 public:
     UrlRequestInterceptor(QObject *parent = nullptr);
     UrlRequestInterceptor(const QList<UrlInterceptorLink> &urlInterceptorLinks, const QString &httpAcceptLanguage, QObject *parnet = nullptr);
+    ~UrlRequestInterceptor() override;
+
     void interceptRequest(QWebEngineUrlRequestInfo &info) override;
 
+    // replace the rules, invalidates the decision cache
+    // compiles the rules on the calling thread before swapping them in
+    void setUrlInterceptorLinks(const QList<UrlInterceptorLink> &urlInterceptorLinks, const QString &httpAcceptLanguage = QString());
+    void setRules(const std::shared_ptr<const UrlInterceptorRules> &rules);
+
+    // current rule snapshot
+    inline const std::shared_ptr<const UrlInterceptorRules> &rules() const
+    { return this->m_rules; }
+
+    // decision cache effectiveness
+    inline quint64 cacheHits() const { return this->m_cacheHits; }
+    inline quint64 cacheMisses() const { return this->m_cacheMisses; }
+
+    // intercepted requests and time spent in interceptRequest()
+    inline quint64 requests() const { return this->m_latency.count(); }
+    inline quint64 redirects() const { return this->m_redirects; }
+    inline quint64 blocked() const { return this->m_blocked; }
+    inline quint64 interceptNsecs() const { return this->m_latency.total(); }
+    inline const LatencyHistogram &latency() const { return this->m_latency; }
+
+    // counters, latency histogram and hits of every rule of the current rules
+    //  > {"requests": n, "redirects": n, "blocked": n, "cacheHits": n, "cacheMisses": n,
+    //     "latency": {...}, "rules": [{"rule": "...", "target": "...", "hits": n}, ...]}
+    QJsonObject statistics() const;
+    bool writeStatistics(const QString &file) const;
+
+    // every request the page made, see TrafficProfiler
+    inline TrafficProfiler &traffic() { return this->m_traffic; }
+
+    // record all requests to a trace file for the InterceptorReplay benchmark
+    void recordTrace(const QString &file);
+
 private:
-    QList<UrlInterceptorLink> urlInterceptorLinks;
-    QString httpAcceptLanguage;
+    std::shared_ptr<const UrlInterceptorRules> m_rules;
+
+    quint64 m_cacheHits = 0;
+    quint64 m_cacheMisses = 0;
+    quint64 m_redirects = 0;
+    quint64 m_blocked = 0;
+    LatencyHistogram m_latency;
+    TrafficProfiler m_traffic;
+    std::unique_ptr<RequestTrace> m_trace;
 };
 
 #endif // URLREQUESTINTERCEPTOR_HPP
@@ -5,8 +5,12 @@
 
 #include <Core/ConfigManager.hpp>
 #include <Core/StreamingProviderStore.hpp>
+#include <Core/StreamingProviderWatcher.hpp>
+#include <Core/ProviderIconLoader.hpp>
+#include <Core/IconCache.hpp>
 
 #include <Util/UserAgent.hpp>
+#include <Util/TargetCache.hpp>
 
 BrowserWindow::BrowserWindow(QWidget *parent)
     : BaseWindow(parent)
@@ -54,6 +58,8 @@ BrowserWindow::BrowserWindow(QWidget *parent)
     new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_F5), this, SLOT(forceReload()));
 
     new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_F7), this, SLOT(clearCookies()));
+    new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_F8), this, SLOT(refreshTargetCache()));
+    new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_F9), this, SLOT(writeInterceptorStatistics()));
 
     // Backup current user-agent
     this->m_originalUserAgent = this->webView->page()->profile()->httpUserAgent();
@@ -84,6 +90,24 @@ BrowserWindow::BrowserWindow(QWidget *parent)
     js_hideScrollBars.setInjectionPoint(QWebEngineScript::DocumentReady);
     js_hideScrollBars.setSourceCode(this->mJs_hideScrollBars);
     this->scripts->insert(js_hideScrollBars);
+
+    // serve url interceptor targets from the local cache
+    this->webView->page()->profile()->installUrlSchemeHandler(TargetCache::scheme, TargetCache::instance());
+
+    // installed once, providers only swap the rules
+    this->m_interceptor = new UrlRequestInterceptor();
+    this->webView->page()->setUrlRequestInterceptor(this->m_interceptor);
+    if (!Config()->recordTraceFile().isEmpty())
+        this->m_interceptor->recordTrace(Config()->recordTraceFile());
+
+    // pick up edited interceptor rules and block lists of the current provider
+    QObject::connect(StreamingProviderWatcher::instance(), &StreamingProviderWatcher::providerChanged, this, [&](const QString &id){
+        if (id != this->m_cookieStoreId)
+            return;
+        const auto pr = StreamingProviderStore::instance()->provider(id);
+        this->setUrlInterceptorEnabled(pr.urlInterceptor);
+        this->setRequestRules(pr);
+    });
 }
 
 QWebEngineScript BrowserWindow::loadScript(const QString &filename, Script::InjectionPoint injection_pt)
@@ -180,6 +204,7 @@ BrowserWindow::~BrowserWindow()
     this->scripts->clear();
 
     // delete url interceptor
+    this->webView->page()->setUrlRequestInterceptor(nullptr);
     delete m_interceptor;
 
     // delete address bar
@@ -247,7 +272,12 @@ void BrowserWindow::setWindowIcon(const QIcon &icon)
     if (icon.isNull())
     {
         QWidget::setWindowIcon(qApp->windowIcon());
-        this->titleBar()->setIcon(qApp->windowIcon().pixmap(23, 23, QIcon::Normal, QIcon::On));
+
+        // avoid rasterizing the application icon on every launch
+        const auto image = IconCache::image(":/app-icon.svgz", ProviderIconLoader::titleBarIconSize, this->devicePixelRatioF());
+        this->titleBar()->setIcon(image.isNull() ?
+            qApp->windowIcon().pixmap(23, 23, QIcon::Normal, QIcon::On) :
+            QPixmap::fromImage(image));
     }
     else
     {
@@ -305,32 +335,29 @@ void BrowserWindow::setUrl(const QUrl &url)
     emit urlChanged(url);
 }
 
-void BrowserWindow::setUrlInterceptorEnabled(bool b, const QList<UrlInterceptorLink> &urlInterceptorLinks, const QString &httpAcceptLanguage)
+void BrowserWindow::setUrlInterceptorEnabled(bool b)
 {
-    if (this->m_interceptor)
-        delete this->m_interceptor;
-
     this->m_interceptorEnabled = b;
     if (b)
     {
         qDebug() << "URL Interceptor enabled!";
-        this->m_interceptor = new UrlRequestInterceptor(urlInterceptorLinks, httpAcceptLanguage);
-        this->webView->page()->profile()->setUrlRequestInterceptor(this->m_interceptor);
-
         this->webView->settings()->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, true);
         this->webView->settings()->setAttribute(QWebEngineSettings::AllowRunningInsecureContent, true);
     }
     else
     {
         qDebug() << "URL Interceptor disabled!";
-        this->m_interceptor = nullptr;
-        this->webView->page()->profile()->setUrlRequestInterceptor(nullptr);
-
         this->webView->settings()->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, false);
         this->webView->settings()->setAttribute(QWebEngineSettings::AllowRunningInsecureContent, false);
     }
 }
 
+void BrowserWindow::setRequestRules(const Provider &provider)
+{
+    // compiled before the swap, block lists apply even with the interceptor disabled
+    this->m_interceptor->setRules(std::make_shared<const UrlInterceptorRules>(provider));
+}
+
 void BrowserWindow::setProfile(const QString &id)
 {
     this->m_engineProfilePath = Config()->webEngineProfiles() + '/' + id;
@@ -387,6 +414,14 @@ void BrowserWindow::showEvent(QShowEvent *event)
 
 void BrowserWindow::closeEvent(QCloseEvent *event)
 {
+    // before the rules of the provider are replaced
+    if (this->m_interceptor->requests() != 0)
+        this->writeInterceptorStatistics();
+
+    //  > Statistics/{provider}-traffic.json
+    if (this->m_interceptor->traffic().requests() != 0)
+        this->m_interceptor->traffic().writeReport(Config()->statisticsDir() + '/' + this->m_cookieStoreId + "-traffic.json");
+    this->m_interceptor->traffic().clear();
     this->resetProfile();
     event->accept();
     emit closed();
@@ -408,6 +443,18 @@ void BrowserWindow::clearCookies()
     this->webView->page()->profile()->cookieStore()->deleteAllCookies();
 }
 
+void BrowserWindow::refreshTargetCache()
+{
+    TargetCache::instance()->refresh();
+    this->forceReload();
+}
+
+void BrowserWindow::writeInterceptorStatistics()
+{
+    //  > Statistics/{provider}-interceptor.json
+    this->m_interceptor->writeStatistics(Config()->statisticsDir() + '/' + this->m_cookieStoreId + "-interceptor.json");
+}
+
 void BrowserWindow::onLoadProgress(int progress)
 {
     // soon™
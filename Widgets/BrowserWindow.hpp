@@ -43,7 +43,8 @@ public:
     void setTitleBarColor(const QColor &color, const QColor &textColor);
     void setBaseTitle(const QString &title, bool permanent = false);
     void setUrl(const QUrl &url);
-    void setUrlInterceptorEnabled(bool, const QList<UrlInterceptorLink> &urlInterceptorLinks = QList<UrlInterceptorLink>(), const QString &httpAcceptLanguage = QString());
+    void setUrlInterceptorEnabled(bool);
+    void setRequestRules(const Provider &provider);
     void setProfile(const QString &id);
     void setScripts(const QList<Script> &scripts);
     void removeScripts();
@@ -63,6 +64,8 @@ public slots:
     void toggleFullScreen();
     void forceReload();
     void clearCookies();
+    void refreshTargetCache();
+    void writeInterceptorStatistics();
     void onLoadProgress(int);
     void onLoadFinished(bool);
 
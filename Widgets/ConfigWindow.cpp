@@ -2,6 +2,7 @@
 
 #include <Core/ConfigManager.hpp>
 #include <Core/StreamingProviderStore.hpp>
+#include <Core/StreamingProviderWatcher.hpp>
 
 #include <Gui/ProviderButton.hpp>
 
@@ -88,10 +89,11 @@ ConfigWindow::ConfigWindow(QWidget *parent)
 
     this->setContentsMargins(0, 0, 0, 0);
 
-    QObject::connect(this->m_editWidget, &ProviderEditWidget::providersUpdated, this, [&]{
-        static_cast<ProviderListModel*>(this->m_tblView->model())->reload();
-        emit providersUpdated();
-    });
+    // store entries move on insertion and removal
+    QObject::connect(StreamingProviderWatcher::instance(), &StreamingProviderWatcher::providerAdded,
+                     this->m_editWidget, &ProviderEditWidget::resolveProvider);
+    QObject::connect(StreamingProviderWatcher::instance(), &StreamingProviderWatcher::providerRemoved,
+                     this->m_editWidget, &ProviderEditWidget::resolveProvider);
 }
 
 ConfigWindow::~ConfigWindow()
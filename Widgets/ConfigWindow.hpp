@@ -17,7 +17,6 @@ public:
     ~ConfigWindow();
 
 signals:
-    void providersUpdated();
     void closed();
 
 protected:
@@ -3,6 +3,7 @@
 #include <Core/ConfigManager.hpp>
 #include <Core/StreamingProviderStore.hpp>
 #include <Core/BrowserWindowProcess.hpp>
+#include <Core/StreamingProviderWatcher.hpp>
 
 #include <Gui/ProviderButton.hpp>
 
@@ -65,7 +66,6 @@ MainWindow::MainWindow(QWidget *parent)
     this->titleBar()->addButton("⚙", [&]{
         ConfigWindow *w = new ConfigWindow();
         w->setWindowModality(Qt::ApplicationModal);
-        QObject::connect(w, &ConfigWindow::providersUpdated, this, &MainWindow::updateProviderList);
         QObject::connect(w, &ConfigWindow::closed, w, &ConfigWindow::deleteLater);
         QObject::connect(w, &ConfigWindow::closed, this, [&]{
             this->setWindowOpacity(1.0);
@@ -76,6 +76,12 @@ MainWindow::MainWindow(QWidget *parent)
 
     this->updateProviderList();
 
+    // update only the affected buttons on provider changes
+    const auto watcher = StreamingProviderWatcher::instance();
+    QObject::connect(watcher, &StreamingProviderWatcher::providerAdded, this, &MainWindow::insertProviderButton);
+    QObject::connect(watcher, &StreamingProviderWatcher::providerChanged, this, &MainWindow::updateProviderButton);
+    QObject::connect(watcher, &StreamingProviderWatcher::providerRemoved, this, &MainWindow::removeProviderButton);
+
     new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_Q), this, SLOT(close()));
 }
 
@@ -131,6 +137,35 @@ void MainWindow::updateProviderList()
     }
 }
 
+void MainWindow::insertProviderButton(const QString &, int index)
+{
+    if (index < 0 || index > this->_providerBtns.size())
+        return;
+
+    QPushButton *btn = ProviderButton::create(StreamingProviderStore::instance()->providerAt(index));
+    this->_providerBtns.insert(index, btn);
+    this->_lF_providerButtonList->insertWidget(index, btn);
+    QObject::connect(btn, &QPushButton::clicked, this, &MainWindow::launchBrowserWindow);
+}
+
+void MainWindow::updateProviderButton(const QString &, int index)
+{
+    if (index < 0 || index >= this->_providerBtns.size())
+        return;
+
+    ProviderButton::update(this->_providerBtns.at(index), StreamingProviderStore::instance()->providerAt(index));
+}
+
+void MainWindow::removeProviderButton(const QString &, int index)
+{
+    if (index < 0 || index >= this->_providerBtns.size())
+        return;
+
+    QPushButton *btn = this->_providerBtns.takeAt(index);
+    delete this->_lF_providerButtonList->takeAt(index);
+    btn->deleteLater();
+}
+
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     Config()->setMainWindowGeometry(this->geometry());
@@ -18,6 +18,10 @@ private slots:
     void launchBrowserWindow();
     void updateProviderList();
 
+    void insertProviderButton(const QString &id, int index);
+    void updateProviderButton(const QString &id, int index);
+    void removeProviderButton(const QString &id, int index);
+
 protected:
     void closeEvent(QCloseEvent *event);
 
@@ -8,6 +8,7 @@
 #include <Gui/ProviderButton.hpp>
 #include <Core/StreamingProviderParser.hpp>
 #include <Core/StreamingProviderWriter.hpp>
+#include <Core/StreamingProviderWatcher.hpp>
 #include <Util/RandomString.hpp>
 
 #include "ConfigWindow.hpp"
@@ -92,7 +93,7 @@ ProviderEditWidget::ProviderEditWidget(QWidget *parent)
     this->_icon = create_lineedit("Icon", ICON);
     this->_url = create_lineedit("URL", URL);
     this->_urlInterceptor = create_checkbbox("URL Interceptor", URL_INTERCEPTOR);
-    this->_urlInterceptorLinks = create_tablewidget(0, 2, {}, {"Pattern", "Target URL"}, "URL_INTERCEPTOR_LINKS", true, false);
+    this->_urlInterceptorLinks = create_tablewidget(0, 3, {}, {"Pattern", "Target URL", "Resource Types"}, "URL_INTERCEPTOR_LINKS", true, false);
     this->_scriptsLabel = create_label("Scripts");
     this->_scripts = create_textedit(SCRIPTS);
     this->_useragent = create_lineedit("User Agent", USERAGENT);
@@ -215,11 +216,18 @@ void ProviderEditWidget::setProvider(Provider *provider)
 
     // pointer to real object (for saving later)
     this->provider_ptr = provider;
+    this->provider_id = provider->id;
 
     this->_update();
     first_start = false;
 }
 
+void ProviderEditWidget::resolveProvider()
+{
+    // the pointer is invalidated when providers are added or removed
+    this->provider_ptr = StreamingProviderStore::instance()->provider_ptr(this->provider_id);
+}
+
 void ProviderEditWidget::_update()
 {
     is_updating = true;
@@ -241,14 +249,20 @@ void ProviderEditWidget::_update()
         const auto row = this->_urlInterceptorLinks->rowCount();
         this->_urlInterceptorLinks->insertRow(row);
 
-        auto pattern = new QTableWidgetItem(i.pattern.pattern());
+        // structured rules are prefixed with "match:"
+        auto pattern = new QTableWidgetItem(i.match.isValid() ? "match:" + QString(i.match) : i.pattern.pattern());
         this->_urlInterceptorLinkItems.append(pattern);
 
         auto target = new QTableWidgetItem(i.target.toString());
         this->_urlInterceptorLinkItems.append(target);
 
+        // empty = all resource types
+        auto resourceTypes = new QTableWidgetItem(UrlInterceptorLink::resourceTypesToString(i.resourceTypes));
+        this->_urlInterceptorLinkItems.append(resourceTypes);
+
         this->_urlInterceptorLinks->setItem(row, 0, pattern);
         this->_urlInterceptorLinks->setItem(row, 1, target);
+        this->_urlInterceptorLinks->setItem(row, 2, resourceTypes);
     }
 
     this->_scripts->clear();
@@ -268,6 +282,10 @@ void ProviderEditWidget::_update()
 
 void ProviderEditWidget::_save()
 {
+    // no provider selected
+    if (!this->provider_ptr)
+        return;
+
     qDebug() << "Saving" << this->provider_ptr->id << "...";
     if (provider_renamed)
         qDebug() << "Hint: Provider was renamed to" << this->provider.id;
@@ -284,9 +302,8 @@ void ProviderEditWidget::_save()
     // routine for config file renaming on id change
     if (provider_renamed)
     {
-        // check for id conflict
-        if (StreamingProviderStore::instance()->contains(this->provider.id) &&
-            !this->provider.isSystem)
+        // check for id conflict, overrides of system providers included
+        if (StreamingProviderStore::instance()->contains(this->provider.id))
         {
             qDebug() << "Error: ID" << this->provider.id << "is already taken! Canceling save...";
             return;
@@ -328,8 +345,9 @@ void ProviderEditWidget::_save()
     {
         case StreamingProviderWriter::SUCCESS:
             // modify provider in memory on success
-            (*this->provider_ptr) = this->provider;
-            emit providersUpdated();
+            StreamingProviderWatcher::instance()->updateProvider(this->provider_id, this->provider);
+            this->provider_id = this->provider.id;
+            this->resolveProvider();
             qDebug() << "Successfully saved" << this->provider_ptr->id;
             break;
         case StreamingProviderWriter::PERM_ERROR:
@@ -413,10 +431,25 @@ void ProviderEditWidget::table_option_changed(int row, int column)
 
         if (option == "URL_INTERCEPTOR_LINKS")
         {
-            if (column == 0) // pattern
-                provider.urlInterceptorLinks[row].pattern = QRegExp(_urlInterceptorLinks->item(row, 0)->text());
+            if (column == 0) // pattern or "match:" rule
+            {
+                const auto rule = _urlInterceptorLinks->item(row, 0)->text();
+                auto &link = provider.urlInterceptorLinks[row];
+                if (rule.startsWith("match:"))
+                {
+                    link.pattern = QRegExp();
+                    link.match = UrlMatch::parse(rule.mid(6));
+                }
+                else
+                {
+                    link.pattern = QRegExp(rule);
+                    link.match = UrlMatch();
+                }
+            }
             else if (column == 1) // url target
                 provider.urlInterceptorLinks[row].target = QUrl(_urlInterceptorLinks->item(row, 1)->text());
+            else if (column == 2) // resource types
+                provider.urlInterceptorLinks[row].resourceTypes = UrlInterceptorLink::parseResourceTypes(_urlInterceptorLinks->item(row, 2)->text());
         }
     }
 }
@@ -440,8 +473,10 @@ void ProviderEditWidget::button_clicked()
                 if (QFile(filename).remove())
                 {
                     qDebug() << "Removed provider!";
-                    StreamingProviderStore::instance()->removeProvider(this->provider_ptr->id);
-                    emit providersUpdated();
+                    const auto id = this->provider_id;
+                    this->provider_ptr = nullptr;
+                    this->provider_id.clear();
+                    StreamingProviderWatcher::instance()->removeProvider(id);
                 }
                 else
                 {
@@ -493,8 +528,7 @@ void ProviderEditWidget::button_clicked()
             Provider p;
             p.id = "new-" + RandomString::Hex(4);
             p.name = "New Provider";
-            StreamingProviderStore::instance()->addProvider(p);
-            emit providersUpdated();
+            StreamingProviderWatcher::instance()->addProvider(p);
         }
     }
 }
@@ -25,15 +25,14 @@ public:
     ProviderEditWidget(QWidget *parent = nullptr);
     ~ProviderEditWidget();
 
-signals:
-    void providersUpdated();
-
 public slots:
     void setProvider(Provider *provider);
+    void resolveProvider();
 
 private:
     Provider provider;
     Provider *provider_ptr = nullptr;
+    QString provider_id;
 
     bool first_start = true;
     bool is_updating = false;
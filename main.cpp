@@ -5,15 +5,24 @@
 #include <Core/ConfigManager.hpp>
 #include <Core/StreamingProviderParser.hpp>
 #include <Core/StreamingProviderStore.hpp>
+#include <Core/StreamingProviderCache.hpp>
+#include <Core/StreamingProviderWatcher.hpp>
+#include <Core/BrowserWindowProcess.hpp>
+#include <Core/ProviderIconLoader.hpp>
+#include <Core/IconCache.hpp>
 
 #include <Widgets/MainWindow.hpp>
 #include <Widgets/BrowserWindow.hpp>
 
+#include <Util/TargetCache.hpp>
+#include <Util/RequestTrace.hpp>
+
 #include <QDebug>
 
 #include <QFile>
 #include <QFileInfo>
 #include <QByteArray>
+#include <QTimer>
 
 void compress_plugin(const QString &in, int level = -1)
 {
@@ -36,21 +45,8 @@ void compress_plugin(const QString &in, int level = -1)
     }
 }
 
-int main(int argc, char **argv)
+static void loadProviders()
 {
-    QApplication::setDesktopSettingsAware(false);
-    QApplication a(argc, argv);
-    a.setApplicationName(QLatin1String("LightweightQtDRMStreamViewer"));
-    a.setApplicationDisplayName(QLatin1String("Qt DRM Stream Viewer"));
-    a.setApplicationVersion("0.5");
-    a.setWindowIcon(QIcon(":/app-icon.svgz"));
-
-    if (a.arguments().contains("-c"))
-    {
-        compress_plugin(a.arguments().at(2), 9);
-        return 0;
-    }
-
     StreamingProviderParser parser;
     parser.findAll();
     if (parser.providers().isEmpty())
@@ -63,37 +59,86 @@ int main(int argc, char **argv)
     }
 
     qDebug() << "\n-------------------------\n";
-    for (auto&& i : parser.providers())
-    {
-        // parse provider file
-        StreamingProviderParser::StatusCode status = parser.parse(i);
 
-        switch (status)
+    // warm start: skip parsing when none of the provider files changed
+    if (!StreamingProviderCache::load(parser.providers()))
+    {
+        for (auto&& i : parser.parseAll())
         {
-            case StreamingProviderParser::SUCCESS:
-                qDebug() << "Added" << i << "to the list of streaming providers.";
-                break;
-            case StreamingProviderParser::FILE_ERROR:
-                qDebug() << "File" << i << "is faulty and was skipped!";
-                break;
-            case StreamingProviderParser::SYNTAX_ERROR:
-                qDebug() << "The file for provider" << i << "has issues. Please check the template. File skipped!";
-                break;
-            case StreamingProviderParser::FILE_EMPTY:
-                qDebug() << "File" << i << "is empty and was skipped!";
-                break;
-            case StreamingProviderParser::ALREADY_IN_LIST:
-                qDebug() << "Provider" << QFileInfo(i).baseName() << "is already in the list from a higher priority target! Skipped.";
-                break;
+            switch (i.status)
+            {
+                case StreamingProviderParser::SUCCESS:
+                    qDebug() << "Added" << i.file << "to the list of streaming providers.";
+                    break;
+                case StreamingProviderParser::FILE_ERROR:
+                    qDebug() << "File" << i.file << "is faulty and was skipped!";
+                    break;
+                case StreamingProviderParser::SYNTAX_ERROR:
+                    qDebug() << "The file for provider" << i.file << "has issues. Please check the template. File skipped!";
+                    break;
+                case StreamingProviderParser::FILE_EMPTY:
+                    qDebug() << "File" << i.file << "is empty and was skipped!";
+                    break;
+                case StreamingProviderParser::ALREADY_IN_LIST:
+                    qDebug() << "Provider" << QFileInfo(i.file).baseName() << "is already in the list from a higher priority target! Skipped.";
+                    break;
+            }
+
+            qDebug() << "\n-------------------------\n";
         }
 
-        StreamingProviderStore::instance()->sort();
+        StreamingProviderCache::save(parser.providers());
 
-        qDebug() << "\n-------------------------\n";
+        // icons of removed providers and replaced icon files, the title bar icon is always used
+        IconCache::prune(ProviderIconLoader::iconFiles() << QLatin1String(":/app-icon.svgz"));
     }
+}
 
-    qDebug() << "Initializing Qt Web Engine...";
-    QtWebEngine::initialize();
+// kiosk mode: only the highest priority file of the requested provider is parsed
+static void loadProvider(const QString &provider_name)
+{
+    StreamingProviderParser parser;
+    parser.findProvider(provider_name);
+
+    switch (parser.parse(provider_name))
+    {
+        case StreamingProviderParser::SUCCESS:
+            qDebug() << "Added" << parser.effectiveProviders() << "to the list of streaming providers.";
+            break;
+        case StreamingProviderParser::FILE_ERROR:
+            qDebug() << "File for provider" << provider_name << "not found or faulty!";
+            break;
+        case StreamingProviderParser::SYNTAX_ERROR:
+            qDebug() << "The file for provider" << provider_name << "has issues. Please check the template.";
+            break;
+        case StreamingProviderParser::FILE_EMPTY:
+            qDebug() << "File for provider" << provider_name << "is empty!";
+            break;
+        case StreamingProviderParser::ALREADY_IN_LIST:
+            break;
+    }
+
+    qDebug() << "\n-------------------------\n";
+}
+
+int main(int argc, char **argv)
+{
+    QApplication::setDesktopSettingsAware(false);
+
+    // custom url schemes must be known before Qt Web Engine starts
+    TargetCache::registerScheme();
+
+    QApplication a(argc, argv);
+    a.setApplicationName(QLatin1String("LightweightQtDRMStreamViewer"));
+    a.setApplicationDisplayName(QLatin1String("Qt DRM Stream Viewer"));
+    a.setApplicationVersion("0.5");
+    a.setWindowIcon(QIcon(":/app-icon.svgz"));
+
+    if (a.arguments().contains("-c"))
+    {
+        compress_plugin(a.arguments().at(2), 9);
+        return 0;
+    }
 
     if (a.arguments().contains("--fullscreen", Qt::CaseInsensitive) ||
         a.arguments().contains("-fs", Qt::CaseInsensitive))
@@ -107,8 +152,46 @@ int main(int argc, char **argv)
         {
             Config()->startupProfile() = i.mid(11);
         }
+        else if (i.startsWith("--record-trace=", Qt::CaseInsensitive))
+        {
+            Config()->recordTraceFile() = i.mid(15);
+        }
     }
 
+    // spawned by the main interface: the provider is handed over pre-parsed on stdin
+    bool providerReceived = false;
+    if (!Config()->startupProfile().isEmpty() && a.arguments().contains("--provider-stdin"))
+    {
+        QFile in;
+        Provider provider;
+        if (in.open(stdin, QFile::ReadOnly) &&
+            BrowserWindowProcess::readProvider(&in, &provider) &&
+            provider.id == Config()->startupProfile())
+        {
+            qDebug() << "Received provider" << provider.id << "from the main interface.";
+            StreamingProviderStore::instance()->addProvider(provider);
+            providerReceived = true;
+        }
+        else
+        {
+            qDebug() << "No valid provider received from the main interface. Parsing providers...";
+        }
+    }
+
+    // several windows can be opened from the main interface, don't write into the same trace
+    if (!Config()->recordTraceFile().isEmpty() && a.arguments().contains("--provider-stdin"))
+        Config()->recordTraceFile() = RequestTrace::processFile(Config()->recordTraceFile(), Config()->startupProfile());
+
+    if (!providerReceived)
+    {
+        Config()->startupProfile().isEmpty() ?
+            loadProviders() :
+            loadProvider(Config()->startupProfile());
+    }
+
+    qDebug() << "Initializing Qt Web Engine...";
+    QtWebEngine::initialize();
+
     // Skip main interface and directly load the given provider
     if (!Config()->startupProfile().isEmpty())
     {
@@ -125,9 +208,18 @@ int main(int argc, char **argv)
         BrowserWindow *w = BrowserWindow::getInstance();
         w->setProfile(pr);
 
+        QObject::connect(ProviderIconLoader::instance(), &ProviderIconLoader::iconLoaded, w, [w, id = pr.id](const QString &provider, const QIcon &icon){
+            if (provider == id)
+                w->setWindowIcon(icon);
+        });
+        ProviderIconLoader::instance()->load(pr);
+
         qDebug() << "Everything done. Enjoy your shows/movies :D";
         Config()->fullScreenMode() ? w->showFullScreen() : w->show();
 
+        // apply edited interceptor rules without restarting, not needed for the first page load
+        QTimer::singleShot(0, StreamingProviderWatcher::instance(), &StreamingProviderWatcher::start);
+
         auto status_code = a.exec();
         delete BrowserWindow::getInstance();
         return status_code;
@@ -135,7 +227,9 @@ int main(int argc, char **argv)
     else
     {
         qDebug() << "Loading interface...";
+        StreamingProviderWatcher::instance()->start();
         MainWindow w;
+        ProviderIconLoader::instance()->loadAll();
 
         qDebug() << "Everything done. Enjoy your shows/movies :D";
         w.show();